@@ -0,0 +1,44 @@
+// 替换全局 operator new/delete, 统计堆分配次数与字节数
+// 只能被一个翻译单元包含
+#ifndef ALLOCCOUNTERH
+#define ALLOCCOUNTERH
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace alloc_counter
+{
+    inline std::atomic<std::size_t> allocations{0};
+    inline std::atomic<std::size_t> bytes{0};
+
+    struct Snapshot
+    {
+        std::size_t allocations;
+        std::size_t bytes;
+    };
+
+    inline Snapshot snapshot() { return {allocations.load(), bytes.load()}; }
+
+    inline Snapshot since(const Snapshot &start)
+    {
+        const Snapshot now = snapshot();
+        return {now.allocations - start.allocations, now.bytes - start.bytes};
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    alloc_counter::allocations.fetch_add(1, std::memory_order_relaxed);
+    alloc_counter::bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return ::operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+#endif
@@ -0,0 +1,110 @@
+// 对同一个奇数模数做大量独立的模乘: 逐个 a * b % m 与 ModContext::mul_mod_batch 在各指令集与线程池下的吞吐量
+// 计时前先检查各指令集与线程池下的结果与 a * b % m 一致, 不一致时返回 1
+#include "ModContext.h"
+#include "TaskPool.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // 取 5 次中最快的一次, 单位为每个乘积的纳秒数
+    double time_batch(const std::size_t count, const std::function<void()> &run) { return bench::time_best(5, 1, run) * 1e9 / static_cast<double>(count); }
+
+    // 在每个可用的指令集下, 分别不用线程, 使用 executor 以及原地计算, 与逐个 a * b % m 的结果比较
+    // 模数有奇有偶, 批次长度包括不是 8 的倍数以及需要拆成多个任务的情况
+    bool check_batch(std::mt19937_64 &rng, const mpn::Isa detected, Executor &executor)
+    {
+        for (const std::size_t digits : {1, 9, 20, 77, 155, 617})
+        {
+            for (const bool odd : {true, false})
+            {
+                BigInt mod(bench::random_digits(rng, digits));
+                if ((mod % BigInt(false, static_cast<std::uint32_t>(2)) == BigInt()) == odd)
+                    mod += BigInt(false, static_cast<std::uint32_t>(1));
+                const ModContext context(mod);
+
+                for (const std::size_t count : {1, 7, 8, 13, 1029})
+                {
+                    // 操作数不一定小于模数
+                    std::vector<BigInt> a, b, expect;
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        a.push_back(BigInt(bench::random_digits(rng, 1 + rng() % (digits + 2))));
+                        b.push_back(BigInt(bench::random_digits(rng, 1 + rng() % (digits + 2))));
+                        expect.push_back(a[i] * b[i] % mod);
+                    }
+
+                    for (const mpn::Isa isa : {mpn::Isa::scalar, mpn::Isa::avx2, mpn::Isa::avx512})
+                    {
+                        if (isa > detected)
+                            continue;
+                        mpn::select_isa(isa);
+                        std::vector<BigInt> serial(count), threaded(count), inplace(a);
+                        context.mul_mod_batch(a, b, serial);
+                        context.mul_mod_batch(a, b, threaded, &executor);
+                        context.mul_mod_batch(inplace, b, inplace);
+                        if (serial != expect || threaded != expect || inplace != expect)
+                        {
+                            std::printf("mismatch: %zu-digit %s modulus, %zu pairs, %s\n", digits, odd ? "odd" : "even", count, mpn::isa_name(isa));
+                            mpn::select_isa(detected);
+                            return false;
+                        }
+                    }
+                    mpn::select_isa(detected);
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    constexpr std::size_t COUNT = 1 << 14;
+    const mpn::Isa detected = mpn::detected_isa();
+    TaskPool &pool = TaskPool::shared();
+    std::mt19937_64 rng = bench::make_rng();
+    // 共享线程池只有一个工作线程时, 另用 3 个工作线程的线程池检查多个任务并发的情况
+    TaskPool check(3);
+    if (!check_batch(rng, detected, pool) || !check_batch(rng, detected, check))
+        return 1;
+
+    std::printf("%zu pairs per batch, %s, %zu worker threads, ns per product\n", COUNT, mpn::isa_name(detected), pool.size());
+    std::printf("%8s %12s %12s %12s %12s %12s\n", "digits", "a*b%m", "scalar", "avx2", "avx512", "threads");
+
+    for (const std::size_t digits : {20, 40, 77, 155, 309, 617})
+    {
+        BigInt mod(bench::random_digits(rng, digits));
+        if (mod % BigInt(false, static_cast<std::uint32_t>(2)) == BigInt())
+            mod += BigInt(false, static_cast<std::uint32_t>(1));
+        const ModContext context(mod);
+        std::vector<BigInt> a, b, results(COUNT);
+        for (std::size_t i = 0; i < COUNT; ++i)
+        {
+            a.push_back(BigInt(bench::random_digits(rng, digits)) % mod);
+            b.push_back(BigInt(bench::random_digits(rng, digits)) % mod);
+        }
+
+        const double loop = time_batch(COUNT, [&]
+                                       {
+                                           for (std::size_t i = 0; i < COUNT; ++i)
+                                               results[i] = a[i] * b[i] % mod;
+                                       });
+        std::printf("%8zu %12.1f", digits, loop);
+        for (const mpn::Isa isa : {mpn::Isa::scalar, mpn::Isa::avx2, mpn::Isa::avx512})
+        {
+            if (isa > detected)
+            {
+                std::printf(" %12s", "-");
+                continue;
+            }
+            mpn::select_isa(isa);
+            std::printf(" %12.1f", time_batch(COUNT, [&] { context.mul_mod_batch(a, b, results); }));
+        }
+        mpn::select_isa(detected);
+        std::printf(" %12.1f\n", time_batch(COUNT, [&] { context.mul_mod_batch(a, b, results, &pool); }));
+    }
+}
@@ -0,0 +1,63 @@
+// 基准程序共用的随机数据与计时工具
+#ifndef BENCHUTILH
+#define BENCHUTILH
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    // 固定种子, 每次运行使用相同的数据
+    inline std::mt19937_64 make_rng(const std::uint64_t seed = 42) { return std::mt19937_64(seed); }
+
+    // len 位的随机十进制数字串, 首位不为 0
+    inline std::string random_digits(std::mt19937_64 &rng, const std::size_t len)
+    {
+        std::string s(len, '0');
+        s[0] = static_cast<char>('1' + rng() % 9);
+        for (std::size_t i = 1; i < len; ++i)
+            s[i] = static_cast<char>('0' + rng() % 10);
+        return s;
+    }
+
+    inline double seconds_since(const Clock::time_point begin) { return std::chrono::duration<double>(Clock::now() - begin).count(); }
+
+    // 反复执行 op, 直到累计不少于 min_seconds; 返回平均每次的秒数
+    template <typename Op>
+    double time_for(const double min_seconds, const Op &op)
+    {
+        std::size_t rounds = 0;
+        double elapsed = 0;
+        const Clock::time_point begin = Clock::now();
+        do
+        {
+            op();
+            ++rounds;
+            elapsed = bench::seconds_since(begin);
+        } while (elapsed < min_seconds);
+        return elapsed / static_cast<double>(rounds);
+    }
+
+    // 做 repeats 轮, 每轮连续执行 op count 次; 返回最快一轮中平均每次的秒数
+    // 不预热, 需要时由调用者先执行一次, 或者取多轮让最快的一轮排除冷启动
+    template <typename Op>
+    double time_best(const std::size_t repeats, const std::size_t count, const Op &op)
+    {
+        double best = 0;
+        for (std::size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            const Clock::time_point begin = Clock::now();
+            for (std::size_t i = 0; i < count; ++i)
+                op();
+            const double elapsed = bench::seconds_since(begin) / static_cast<double>(count);
+            if (repeat == 0 || elapsed < best)
+                best = elapsed;
+        }
+        return best;
+    }
+}
+#endif
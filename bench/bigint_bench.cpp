@@ -0,0 +1,304 @@
+// 各运算在 1 个 limb 到数百万位的操作数上的耗时, 每次运算的堆分配次数与吞吐量
+// 结果可以输出为 JSON 或 CSV, 保存下来与之后的版本比较; 指定 --baseline 时与之前的 CSV 比较, 变慢超过 --tolerance 时返回 1
+// bigint_bench [--max-digits N] [--min-time 秒] [--ops add,mul,...] [--format table|json|csv] [--output 文件] [--baseline 文件.csv] [--tolerance 0.1]
+// cmake --build build --target bigint_bench
+#include "BigInt.h"
+#include "alloc_counter.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const char *const OPS[] = {"add", "sub", "mul", "div", "mod", "pow", "inverse", "from_str", "to_str"};
+    const std::size_t SIZES[] = {9, 30, 100, 300, 1000, 3000, 10000, 30000, 100000, 300000, 1000000, 3000000, 10000000};
+
+    struct Options
+    {
+        std::size_t max_digits = 1000000;
+        double min_time = 0.2;
+        std::vector<std::string> ops;
+        std::string format = "table";
+        std::string output;
+        std::string baseline;
+        double tolerance = 0.1;
+    };
+
+    struct Result
+    {
+        std::string op;
+        std::size_t digits;
+        std::size_t limbs;
+        std::size_t iterations;
+        double ns_per_op;
+        double allocs_per_op;
+        double bytes_per_op;
+        // 每秒处理的操作数位数, 单位百万位
+        double mdigits_per_s;
+    };
+
+    // 先执行一次作为预热, 之后每轮次数加倍, 直到累计时间不少于 min_time; 单次已经超过 min_time 时直接使用第一次的结果
+    Result measure(const std::string &op, const std::size_t digits, const std::size_t limbs, const double min_time, const std::function<void()> &run)
+    {
+        using bench::Clock;
+        std::size_t iterations = 1;
+        alloc_counter::Snapshot start = alloc_counter::snapshot();
+        Clock::time_point begin = Clock::now();
+        run();
+        double elapsed = bench::seconds_since(begin);
+        alloc_counter::Snapshot used = alloc_counter::since(start);
+
+        if (elapsed < min_time)
+        {
+            iterations = 0;
+            start = alloc_counter::snapshot();
+            begin = Clock::now();
+            for (std::size_t batch = 1; elapsed < min_time || iterations == 0; batch *= 2)
+            {
+                for (std::size_t i = 0; i < batch; ++i)
+                    run();
+                iterations += batch;
+                elapsed = bench::seconds_since(begin);
+            }
+            used = alloc_counter::since(start);
+        }
+
+        const double ns = elapsed * 1e9 / static_cast<double>(iterations);
+        return {op,
+                digits,
+                limbs,
+                iterations,
+                ns,
+                static_cast<double>(used.allocations) / static_cast<double>(iterations),
+                static_cast<double>(used.bytes) / static_cast<double>(iterations),
+                static_cast<double>(digits) / ns * 1e3};
+    }
+
+    bool selected(const Options &options, const std::string &op)
+    {
+        if (options.ops.empty())
+            return true;
+        for (const std::string &name : options.ops)
+        {
+            if (name == op)
+                return true;
+        }
+        return false;
+    }
+
+    // 同一规模的全部运算; 除法与取模的被除数为 2 * digits 位, pow 的 digits 指结果的位数
+    void run_size(const Options &options, const std::size_t digits, std::mt19937_64 &rng, std::vector<Result> &results, const std::function<void(const Result &)> &report)
+    {
+        const std::string text = bench::random_digits(rng, digits);
+        const BigInt a(text), b(bench::random_digits(rng, digits)), wide(bench::random_digits(rng, 2 * digits));
+        const std::size_t limbs = a.get_limbs();
+        BigInt sink;
+
+        const auto add = [&](const std::string &op, const std::function<void()> &run)
+        {
+            if (!selected(options, op))
+                return;
+            results.push_back(measure(op, digits, limbs, options.min_time, run));
+            report(results.back());
+        };
+
+        add("add", [&] { sink = a + b; });
+        add("sub", [&] { sink = a - b; });
+        add("mul", [&] { sink = a * b; });
+        add("div", [&] { sink = wide / b; });
+        add("mod", [&] { sink = wide % b; });
+
+        if (selected(options, "pow"))
+        {
+            const BigInt base(false, static_cast<std::uint32_t>(12345));
+            const auto exponent = static_cast<std::uint32_t>(std::max(1.0, std::floor(static_cast<double>(digits) / std::log10(12345.0))));
+            const BigInt exp(false, exponent);
+            add("pow", [&] { sink = base ^ exp; });
+        }
+
+        if (selected(options, "inverse"))
+        {
+            // 取一个与 a 互素的奇数模数
+            BigInt mod(bench::random_digits(rng, digits));
+            const BigInt one(false, static_cast<std::uint32_t>(1)), two(false, static_cast<std::uint32_t>(2));
+            if (mod % two == BigInt())
+                mod += one;
+            BigInt value = a % mod;
+            while (gcd(value, mod) != one)
+                value += one;
+            const BigInt::ModScope scope(mod);
+            add("inverse", [&] { sink = value.inverse(); });
+        }
+
+        add("from_str", [&] { sink = BigInt(text); });
+        std::string str;
+        add("to_str", [&] { str = a.to_str(); });
+    }
+
+    void write_table(std::FILE *out, const Result &r)
+    {
+        std::fprintf(out, "%-9s %9zu %8zu %10zu %14.1f %11.2f %13.1f %12.3f\n", r.op.c_str(), r.digits, r.limbs, r.iterations, r.ns_per_op, r.allocs_per_op, r.bytes_per_op, r.mdigits_per_s);
+    }
+
+    void write_csv(std::FILE *out, const std::vector<Result> &results)
+    {
+        std::fprintf(out, "op,digits,limbs,iterations,ns_per_op,allocs_per_op,bytes_per_op,mdigits_per_s\n");
+        for (const Result &r : results)
+            std::fprintf(out, "%s,%zu,%zu,%zu,%.1f,%.3f,%.1f,%.6f\n", r.op.c_str(), r.digits, r.limbs, r.iterations, r.ns_per_op, r.allocs_per_op, r.bytes_per_op, r.mdigits_per_s);
+    }
+
+    void write_json(std::FILE *out, const Options &options, const std::vector<Result> &results)
+    {
+#if defined(BIGINT_BINARY_LIMBS)
+        const char *radix = "2^64";
+#else
+        const char *radix = "10^9";
+#endif
+        std::fprintf(out, "{\n  \"radix\": \"%s\",\n  \"isa\": \"%s\",\n  \"min_time\": %g,\n  \"results\": [\n", radix, mpn::isa_name(mpn::active_isa()), options.min_time);
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            std::fprintf(out,
+                         "    {\"op\": \"%s\", \"digits\": %zu, \"limbs\": %zu, \"iterations\": %zu, \"ns_per_op\": %.1f, \"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f, \"mdigits_per_s\": %.6f}%s\n",
+                         r.op.c_str(), r.digits, r.limbs, r.iterations, r.ns_per_op, r.allocs_per_op, r.bytes_per_op, r.mdigits_per_s, (i + 1 == results.size()) ? "" : ",");
+        }
+        std::fprintf(out, "  ]\n}\n");
+    }
+
+    // 读取之前 write_csv 的输出, 返回 (运算, 位数) 到 ns/op 的映射
+    std::map<std::pair<std::string, std::size_t>, double> read_baseline(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("cannot open baseline " + path);
+        std::map<std::pair<std::string, std::size_t>, double> baseline;
+        std::string line;
+        std::getline(in, line);
+        while (std::getline(in, line))
+        {
+            std::stringstream fields(line);
+            std::string op, digits, limbs, iterations, ns;
+            if (std::getline(fields, op, ',') && std::getline(fields, digits, ',') && std::getline(fields, limbs, ',') && std::getline(fields, iterations, ',') && std::getline(fields, ns, ','))
+                baseline[{op, std::stoull(digits)}] = std::stod(ns);
+        }
+        return baseline;
+    }
+
+    // 打印比基线慢 tolerance 以上的项, 返回其个数
+    std::size_t compare_baseline(const Options &options, const std::vector<Result> &results)
+    {
+        const std::map<std::pair<std::string, std::size_t>, double> baseline = read_baseline(options.baseline);
+        std::size_t regressions = 0;
+        for (const Result &r : results)
+        {
+            const auto it = baseline.find({r.op, r.digits});
+            if (it == baseline.end() || it->second <= 0)
+                continue;
+            const double change = r.ns_per_op / it->second - 1;
+            if (change > options.tolerance)
+            {
+                std::fprintf(stderr, "regression: %s %zu digits %.1f ns -> %.1f ns (%+.1f%%)\n", r.op.c_str(), r.digits, it->second, r.ns_per_op, change * 100);
+                ++regressions;
+            }
+        }
+        std::fprintf(stderr, "%zu regression(s) against %s\n", regressions, options.baseline.c_str());
+        return regressions;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr, "usage: bigint_bench [--max-digits N] [--min-time SECONDS] [--ops add,sub,mul,div,mod,pow,inverse,from_str,to_str]\n"
+                             "                    [--format table|json|csv] [--output FILE] [--baseline FILE.csv] [--tolerance FRACTION]\n");
+        std::exit(2);
+    }
+
+    Options parse_options(const int argc, char **argv)
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+                usage();
+            const std::string value = argv[++i];
+            if (arg == "--max-digits")
+                options.max_digits = std::stoull(value);
+            else if (arg == "--min-time")
+                options.min_time = std::stod(value);
+            else if (arg == "--format" && (value == "table" || value == "json" || value == "csv"))
+                options.format = value;
+            else if (arg == "--output")
+                options.output = value;
+            else if (arg == "--baseline")
+                options.baseline = value;
+            else if (arg == "--tolerance")
+                options.tolerance = std::stod(value);
+            else if (arg == "--ops")
+            {
+                std::stringstream names(value);
+                std::string name;
+                while (std::getline(names, name, ','))
+                {
+                    if (std::find(std::begin(OPS), std::end(OPS), name) == std::end(OPS))
+                        usage();
+                    options.ops.push_back(name);
+                }
+            }
+            else
+                usage();
+        }
+        return options;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const Options options = parse_options(argc, argv);
+
+    std::FILE *out = stdout;
+    if (!options.output.empty() && (out = std::fopen(options.output.c_str(), "w")) == nullptr)
+    {
+        std::fprintf(stderr, "cannot open %s\n", options.output.c_str());
+        return 2;
+    }
+
+    // 表格边测边输出, JSON 与 CSV 在全部完成后输出
+    const bool table = (options.format == "table");
+    if (table)
+        std::fprintf(out, "%-9s %9s %8s %10s %14s %11s %13s %12s\n", "op", "digits", "limbs", "iterations", "ns/op", "allocs/op", "bytes/op", "Mdigits/s");
+    const auto report = [&](const Result &r)
+    {
+        if (table)
+        {
+            write_table(out, r);
+            std::fflush(out);
+        }
+    };
+    std::vector<Result> results;
+    std::mt19937_64 rng = bench::make_rng();
+    for (const std::size_t digits : SIZES)
+    {
+        if (digits > options.max_digits)
+            break;
+        run_size(options, digits, rng, results, report);
+    }
+
+    if (options.format == "csv")
+        write_csv(out, results);
+    else if (options.format == "json")
+        write_json(out, options, results);
+    if (out != stdout)
+        std::fclose(out);
+
+    if (!options.baseline.empty() && compare_baseline(options, results) != 0)
+        return 1;
+}
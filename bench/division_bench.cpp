@@ -0,0 +1,53 @@
+// 比较 Knuth 除法与 Burnikel-Ziegler 递归除法在不同规模下的耗时
+#include "BigInt.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <limits>
+#include <string>
+
+namespace
+{
+    double time_division(const BigInt &a, const BigInt &b, const std::size_t threshold)
+    {
+        BigInt::Thresholds thresholds = BigInt::get_thresholds();
+        thresholds.burnikel_ziegler = threshold;
+        BigInt::set_thresholds(thresholds);
+
+        const auto divide = [&]
+        {
+            const auto qr = a.divmod(b);
+            if (qr.second.is_zero() && qr.first.is_zero())
+                std::puts("");
+        };
+        return bench::time_for(0.2, divide) * 1e6;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_digits = (argc > 1) ? std::stoull(argv[1]) : 200000;
+    const BigInt::Thresholds defaults = BigInt::get_thresholds();
+    std::mt19937_64 rng = bench::make_rng();
+
+    std::printf("%12s %12s %14s %14s %8s\n", "divisor", "dividend", "knuth(us)", "recursive(us)", "ratio");
+    for (std::size_t digits = 100; digits <= max_digits; digits *= 2)
+    {
+        const BigInt b(bench::random_digits(rng, digits));
+        const BigInt a(bench::random_digits(rng, digits * 2));
+
+        const double knuth = time_division(a, b, std::numeric_limits<std::size_t>::max());
+        const double recursive = time_division(a, b, defaults.burnikel_ziegler);
+        std::printf("%12zu %12zu %14.1f %14.1f %8.2f\n", digits, digits * 2, knuth, recursive, knuth / recursive);
+    }
+
+    // 寻找递归除法开始占优的阈值
+    std::printf("\n%12s %14s %14s\n", "threshold", "knuth(us)", "recursive(us)");
+    const BigInt b(bench::random_digits(rng, 20000));
+    const BigInt a(bench::random_digits(rng, 40000));
+    const double knuth = time_division(a, b, std::numeric_limits<std::size_t>::max());
+    for (std::size_t threshold = 8; threshold <= 256; threshold *= 2)
+        std::printf("%12zu %14.1f %14.1f\n", threshold, knuth, time_division(a, b, threshold));
+
+    BigInt::set_thresholds(defaults);
+    return 0;
+}
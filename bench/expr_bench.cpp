@@ -0,0 +1,46 @@
+// 立即求值与 lazy() 表达式模板在加减链、乘加与乘法取模上的耗时与堆分配次数
+#include "BigIntExpr.h"
+#include "alloc_counter.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace
+{
+    void run(const char *name, const std::size_t rounds, const std::function<void()> &op)
+    {
+        op();
+
+        const alloc_counter::Snapshot start = alloc_counter::snapshot();
+        const double seconds = bench::time_best(1, rounds, op);
+        const alloc_counter::Snapshot used = alloc_counter::since(start);
+
+        std::printf("%-20s %12.1f %12.3f\n", name, seconds * 1e9, static_cast<double>(used.allocations) / rounds);
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng = bench::make_rng();
+    for (const std::size_t digits : {200, 2000, 20000})
+    {
+        const BigInt a(bench::random_digits(rng, digits)), b(bench::random_digits(rng, digits)), c(bench::random_digits(rng, digits)), d(bench::random_digits(rng, digits));
+        const BigInt m(bench::random_digits(rng, digits / 2));
+        const std::size_t rounds = 2000000 / digits;
+        BigInt r;
+
+        std::printf("%zu-digit operands (%zu limbs)\n", digits, a.get_limbs());
+        std::printf("%-20s %12s %12s\n", "op", "ns/op", "allocs/op");
+        run("a+b-c+d", rounds, [&] { r = a + b - c + d; });
+        run("lazy a+b-c+d", rounds, [&] { r = lazy(a) + b - c + d; });
+        run("a*b+c", rounds, [&] { r = a * b + c; });
+        run("lazy a*b+c", rounds, [&] { r = lazy(a) * b + c; });
+        run("(a+b)*(c+d)-a-d", rounds, [&] { r = (a + b) * (c + d) - a - d; });
+        run("lazy (a+b)*(c+d)-a-d", rounds, [&] { r = (lazy(a) + b) * (lazy(c) + d) - a - d; });
+        run("a*b%m", rounds, [&] { r = a * b % m; });
+        run("lazy a*b%m", rounds, [&] { r = (lazy(a) * b) % m; });
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// 256 与 521 位的数上 FixedBigInt 与 BigInt 各运算的耗时
+#include "FixedBigInt.h"
+#include "bench_util.h"
+#include <cstdio>
+
+namespace
+{
+    // 阻止编译器把循环中的运算当作不变量提出或删除
+    template <typename T>
+    void escape(T &value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    template <typename Op>
+    double time_op(const Op &op)
+    {
+        constexpr std::size_t rounds = 200000;
+        op();
+        return bench::time_best(1, rounds, op) * 1e9;
+    }
+
+    template <std::size_t Bits>
+    void run(std::mt19937_64 &rng)
+    {
+        using Fixed = FixedUInt<Bits>;
+        std::array<std::uint64_t, Fixed::LIMBS> la, lb;
+        for (std::size_t i = 0; i < Fixed::LIMBS; ++i)
+        {
+            la[i] = rng();
+            lb[i] = rng();
+        }
+        lb[Fixed::LIMBS - 1] = 0;
+        Fixed fa = Fixed::from_limbs(la), fb = Fixed::from_limbs(lb), fr;
+        BigInt ba(fa), bb(fb), shift(Fixed(1) << 37), br;
+        bool less = false;
+
+        std::printf("%zu bits\n", Bits);
+        std::printf("%-8s %12s %12s\n", "op", "fixed(ns)", "BigInt(ns)");
+        const auto row = [](const char *name, const double fixed, const double big) { std::printf("%-8s %12.1f %12.1f\n", name, fixed, big); };
+        // 每次运算前后都让操作数与结果对编译器不可见
+        const auto fixed = [&](const auto &op)
+        {
+            return time_op(
+                [&]
+                {
+                    escape(fa);
+                    escape(fb);
+                    op();
+                    escape(fr);
+                    escape(less);
+                });
+        };
+        const auto big = [&](const auto &op)
+        {
+            return time_op(
+                [&]
+                {
+                    escape(ba);
+                    escape(bb);
+                    op();
+                    escape(br);
+                    escape(less);
+                });
+        };
+        row("add", fixed([&] { fr = fa + fb; }), big([&] { br = ba + bb; }));
+        row("sub", fixed([&] { fr = fa - fb; }), big([&] { br = ba - bb; }));
+        row("mul", fixed([&] { fr = fa * fb; }), big([&] { br = ba * bb; }));
+        row("divmod", fixed([&] { fr = fa % fb; }), big([&] { br = ba % bb; }));
+        // BigInt 没有移位, 用乘以 2^37 代替
+        row("shift", fixed([&] { fr = fa << 37; }), big([&] { br = ba * shift; }));
+        row("compare", fixed([&] { less = fa < fb; }), big([&] { less = ba < bb; }));
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng = bench::make_rng();
+    run<256>(rng);
+    run<521>(rng);
+}
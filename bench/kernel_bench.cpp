@@ -0,0 +1,78 @@
+// 对比各指令集的 mpn 内核 (add_n, sub_n, mul_1, addmul_1) 及其对 BigInt 运算的影响
+// 每一行依次列出标量, AVX2, AVX-512 内核的耗时; 当前 CPU 不支持的列为 -
+#include "BigInt.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const mpn::Isa ISAS[] = {mpn::Isa::scalar, mpn::Isa::avx2, mpn::Isa::avx512};
+
+    double time_ns(const std::size_t rounds, const std::function<void()> &op)
+    {
+        op();
+        return bench::time_best(5, rounds, op) * 1e9;
+    }
+
+    void row(const char *name, const std::size_t size, const std::size_t rounds, const std::function<void()> &op)
+    {
+        std::printf("%-12s %8zu", name, size);
+        for (const mpn::Isa isa : ISAS)
+        {
+            try
+            {
+                mpn::select_isa(isa);
+            }
+            catch (const std::runtime_error &)
+            {
+                std::printf(" %12s", "-");
+                continue;
+            }
+            std::printf(" %12.1f", time_ns(rounds, op));
+        }
+        std::printf("\n");
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng = bench::make_rng();
+    std::printf("detected: %s\n", mpn::isa_name(mpn::detected_isa()));
+    std::printf("%-12s %8s %12s %12s %12s\n", "op", "limbs", "scalar ns", "avx2 ns", "avx512 ns");
+
+    for (const std::size_t n : {16, 64, 256, 4096})
+    {
+        std::vector<mpn::Limb> a(n), b(n), r(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+#if defined(BIGINT_BINARY_LIMBS)
+            a[i] = rng();
+            b[i] = rng();
+#else
+            a[i] = rng() % mpn::LIMIT;
+            b[i] = rng() % mpn::LIMIT;
+#endif
+        }
+        const mpn::Limb m = b[0] | 1;
+        const std::size_t rounds = 4000000 / n;
+        row("add_n", n, rounds, [&] { mpn::add_n(r, a, b); });
+        row("sub_n", n, rounds, [&] { mpn::sub_n(r, a, b); });
+        row("mul_1", n, rounds, [&] { mpn::mul_1(r, a, m); });
+        row("addmul_1", n, rounds, [&] { mpn::addmul_1(r, a, m); });
+    }
+
+    for (const std::size_t digits : {200, 2000, 20000})
+    {
+        const BigInt x(bench::random_digits(rng, digits)), y(bench::random_digits(rng, digits));
+        const std::size_t rounds = 2000000 / digits;
+        BigInt r;
+        row("a + b", x.get_limbs(), rounds, [&] { r = x + y; });
+        row("a - b", x.get_limbs(), rounds, [&] { r = x - y; });
+        row("a * 12345", x.get_limbs(), rounds, [&] { r = x * static_cast<std::uint32_t>(12345); });
+        row("a * b", x.get_limbs(), std::max<std::size_t>(rounds / 50, 1), [&] { r = x * y; });
+    }
+    return 0;
+}
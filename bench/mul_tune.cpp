@@ -0,0 +1,83 @@
+// 测量乘法各算法之间的交叉点, 输出推荐的 BigInt::Thresholds
+#include "BigInt.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <limits>
+#include <string>
+
+namespace
+{
+    constexpr std::size_t NEVER = std::numeric_limits<std::size_t>::max();
+
+    // 生成约 limbs 个 limb 的随机数
+    BigInt random_number(std::mt19937_64 &rng, const std::size_t limbs)
+    {
+        const auto make = [&rng](const std::size_t len) { return BigInt(bench::random_digits(rng, len)); };
+
+        const std::size_t probe = make(limbs * 9).get_limbs();
+        return make(limbs * 9 * limbs / probe);
+    }
+
+    double time_mul(const BigInt &a, const BigInt &b)
+    {
+        const auto multiply = [&]
+        {
+            const BigInt c = a * b;
+            if (c.is_zero())
+                std::puts("");
+        };
+        return bench::time_for(0.05, multiply) * 1e6;
+    }
+
+    // 在 [low, high] 中寻找 field 对应算法开始占优的 limb 数
+    std::size_t tune(const char *name, std::size_t BigInt::Thresholds::*field, BigInt::Thresholds base, const std::size_t low, const std::size_t high)
+    {
+        std::mt19937_64 rng = bench::make_rng(7);
+        std::printf("%s\n%10s %14s %14s\n", name, "limbs", "below(us)", "above(us)");
+
+        std::size_t found = NEVER;
+        std::size_t wins = 0;
+        for (std::size_t n = low; n <= high; n += n / 8 + 1)
+        {
+            const BigInt a = random_number(rng, n), b = random_number(rng, n);
+
+            base.*field = NEVER;
+            BigInt::set_thresholds(base);
+            const double below = time_mul(a, b);
+
+            base.*field = n;
+            BigInt::set_thresholds(base);
+            const double above = time_mul(a, b);
+
+            std::printf("%10zu %14.2f %14.2f\n", a.get_limbs(), below, above);
+
+            // 连续两次占优才认为越过交叉点
+            wins = (above < below) ? wins + 1 : 0;
+            if (wins == 1)
+                found = n;
+            if (wins == 2)
+                break;
+        }
+        if (wins < 2)
+            found = NEVER;
+
+        std::printf("\n");
+        return found;
+    }
+}
+
+int main()
+{
+    BigInt::Thresholds thresholds = BigInt::get_thresholds();
+    thresholds.toom3 = NEVER;
+    thresholds.ntt = NEVER;
+
+    thresholds.karatsuba = tune("karatsuba", &BigInt::Thresholds::karatsuba, thresholds, 4, 256);
+    thresholds.toom3 = tune("toom3", &BigInt::Thresholds::toom3, thresholds, 16, 2048);
+    thresholds.ntt = tune("ntt", &BigInt::Thresholds::ntt, thresholds, 64, 16384);
+
+    const auto show = [](const std::size_t value)
+    { return value == NEVER ? std::string("never") : std::to_string(value); };
+    std::printf("recommended: karatsuba = %s, toom3 = %s, ntt = %s\n", show(thresholds.karatsuba).c_str(), show(thresholds.toom3).c_str(), show(thresholds.ntt).c_str());
+    return 0;
+}
@@ -0,0 +1,88 @@
+// 顺序与并行乘法的耗时, 先检查线程池上的乘积与顺序乘积一致, 不一致时返回 1; 可选参数为工作线程数 (默认 hardware_concurrency - 1)
+#include "BigInt.h"
+#include "TaskPool.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace
+{
+    // 取多次中最快的一次, 单位毫秒; product 为最后一次的乘积
+    double time_mul(const BigInt &a, const BigInt &b, const int rounds, BigInt &product)
+    {
+        return bench::time_best(rounds, 1, [&] { product = a * b; }) * 1e3;
+    }
+
+    // 用很小的拆分阈值让乘法产生大量嵌套任务, 与顺序计算的乘积逐一比较; 可以在 -fsanitize=thread 下运行
+    bool check_pool(TaskPool &pool, std::mt19937_64 &rng)
+    {
+        BigInt::Parallelism parallelism;
+        parallelism.executor = &pool;
+        parallelism.min_limbs = 32;
+        parallelism.max_depth = 8;
+        for (int i = 0; i < 40; ++i)
+        {
+            const BigInt a(bench::random_digits(rng, 1000 + rng() % 60000)), b(bench::random_digits(rng, 1000 + rng() % 60000));
+            BigInt::set_parallelism(BigInt::Parallelism());
+            const BigInt expect = a * b;
+            BigInt::set_parallelism(parallelism);
+            const BigInt product = a * b;
+            BigInt::set_parallelism(BigInt::Parallelism());
+            if (!(product == expect))
+            {
+                std::printf("mismatch: %zu x %zu limbs on %zu workers\n", a.get_limbs(), b.get_limbs(), pool.size());
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::unique_ptr<TaskPool> own;
+    TaskPool *pool = &TaskPool::shared();
+    if (argc > 1)
+    {
+        own = std::make_unique<TaskPool>(std::strtoul(argv[1], nullptr, 10));
+        pool = own.get();
+    }
+    std::mt19937_64 rng = bench::make_rng();
+    // 工作线程数多于核心数时同样要得到正确的结果
+    for (const std::size_t threads : {0, 1, 3, 7})
+    {
+        TaskPool check(threads);
+        if (!check_pool(check, rng))
+            return 1;
+    }
+    if (!check_pool(*pool, rng))
+        return 1;
+
+    std::printf("%zu worker threads\n", pool->size());
+    std::printf("%10s %14s %14s %8s\n", "digits", "sequential(ms)", "parallel(ms)", "speedup");
+    for (const std::size_t digits : {10000, 100000, 1000000, 4000000, 16000000})
+    {
+        const BigInt a(bench::random_digits(rng, digits)), b(bench::random_digits(rng, digits));
+        const int rounds = (digits >= 4000000) ? 3 : 10;
+
+        BigInt expect, product;
+        BigInt::set_parallelism(BigInt::Parallelism());
+        const double sequential = time_mul(a, b, rounds, expect);
+
+        BigInt::Parallelism parallelism;
+        parallelism.executor = pool;
+        BigInt::set_parallelism(parallelism);
+        const double parallel = time_mul(a, b, rounds, product);
+        if (!(product == expect))
+        {
+            std::printf("mismatch at %zu digits\n", digits);
+            BigInt::set_parallelism(BigInt::Parallelism());
+            return 1;
+        }
+
+        std::printf("%10zu %14.2f %14.2f %8.2f\n", digits, sequential, parallel, sequential / parallel);
+    }
+    BigInt::set_parallelism(BigInt::Parallelism());
+}
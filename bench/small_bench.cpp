@@ -0,0 +1,86 @@
+// 小整数 (1~4 个 limb) 上各运算的耗时与每次运算的堆分配次数; 先检查嵌套的模数绑定, 出错时返回 1
+#include "BigInt.h"
+#include "alloc_counter.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+    void run(const char *name, const std::function<void()> &op)
+    {
+        constexpr std::size_t rounds = 200000;
+        op();
+
+        const alloc_counter::Snapshot start = alloc_counter::snapshot();
+        const double seconds = bench::time_best(1, rounds, op);
+        const alloc_counter::Snapshot used = alloc_counter::since(start);
+
+        std::printf("%-14s %10.1f %12.3f %12.1f\n", name, seconds * 1e9, static_cast<double>(used.allocations) / rounds,
+                    static_cast<double>(used.bytes) / rounds);
+    }
+
+    // 嵌套的 ModScope 与 inject_mod: 作用域内的注入在析构时失效, 之前注入的模数恢复后仍然可用
+    bool check_mod_binding(const BigInt &a, const BigInt &b, BigInt m1, const BigInt &m2, BigInt m3)
+    {
+        const BigInt product = a * b;
+        const BigInt expect1 = product % m1, expect2 = product % m2;
+        bool ok = true;
+        BigInt::inject_mod(&m1);
+        {
+            BigInt::ModScope scope(m2);
+            BigInt::inject_mod(&m3);
+        }
+        ok = ok && a * b == expect1;
+        {
+            BigInt::ModScope scope(m2);
+            BigInt::inject_mod(nullptr);
+        }
+        ok = ok && a * b == expect1;
+        {
+            BigInt::ModScope outer(m2);
+            {
+                BigInt::ModScope inner(m3);
+                BigInt::inject_mod(&m1);
+            }
+            ok = ok && a * b == expect2;
+        }
+        ok = ok && a * b == expect1;
+        BigInt::inject_mod(nullptr);
+        if (!ok)
+            std::printf("mismatch in nested ModScope / inject_mod\n");
+        return ok;
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng = bench::make_rng();
+    const std::size_t digits = 36;
+    const BigInt a(bench::random_digits(rng, digits)), b(bench::random_digits(rng, digits / 2)), neg(-BigInt(bench::random_digits(rng, digits)));
+    const BigInt m(bench::random_digits(rng, digits));
+    BigInt r;
+    if (!check_mod_binding(a, b, m, BigInt(bench::random_digits(rng, 20)), BigInt(bench::random_digits(rng, 12))))
+        return 1;
+
+    std::printf("%zu-digit operands (%zu limbs)\n", digits, a.get_limbs());
+    std::printf("%-14s %10s %12s %12s\n", "op", "ns/op", "allocs/op", "bytes/op");
+    run("construct", [&] { r = BigInt(false, static_cast<std::uint32_t>(12345)); });
+    run("copy", [&] { r = a; });
+    run("add", [&] { r = a + b; });
+    run("sub", [&] { r = b - a; });
+    run("add mixed", [&] { r = a + neg; });
+    run("add in place", [&] { r = a; r += b; r -= neg; });
+    run("mul", [&] { r = a * b; });
+    run("square", [&] { r = a.square(); });
+    run("div", [&] { r = a / b; });
+    run("mod", [&] { r = a % b; });
+    run("compare", [&] { if (a < b) r = a; });
+    {
+        BigInt::ModScope scope(m);
+        run("mod mul", [&] { r = a * b; });
+    }
+    return 0;
+}
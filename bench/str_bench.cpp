@@ -0,0 +1,113 @@
+// 十进制 / 十六进制字符串与字节序列和 BigInt 之间转换的耗时
+// 开始前先核对格式说明 (fill / align / sign / # / 0 / width / 进制) 的输出, 有 <format> 时同时核对 std::format, 不一致时返回 1
+#include "BigInt.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+    double time_ms(const std::function<void()> &op) { return bench::time_for(0.3, op) * 1e3; }
+
+    std::string format_with(const BigInt &num, const std::string &spec_str)
+    {
+        BigInt::FormatSpec spec;
+        BigInt::parse_format_spec(spec_str.begin(), spec_str.end(), spec);
+        std::string out;
+        num.format_to(
+            spec, [](void *context, const char *data, const std::size_t len)
+            { static_cast<std::string *>(context)->append(data, len); },
+            &out);
+        return out;
+    }
+
+    // 期望值与 printf / std::format 对内置整数的输出相同
+    bool check_format()
+    {
+        struct Case
+        {
+            const char *value, *spec, *expected;
+        };
+        const Case cases[] = {
+            {"0", "#o", "0"},
+            {"0", "#6o", "     0"},
+            {"0", "#x", "0x0"},
+            {"0", "#b", "0b0"},
+            {"8", "#o", "010"},
+            {"-8", "#o", "-010"},
+            {"255", ">10", "       255"},
+            {"255", "*^12x", "*****ff*****"},
+            {"-255", "#010X", "-0X00000FF"},
+            {"255", "+#b", "+0b11111111"},
+            {"-42", "<6", "-42   "},
+            {"42", " d", " 42"},
+            {"1267650600228229401496703205376", "#x", "0x10000000000000000000000000"},
+            {"-1267650600228229401496703205376", "_>40o", "_____-2000000000000000000000000000000000"},
+        };
+        bool ok = true;
+        for (const Case &c : cases)
+        {
+            const BigInt num(c.value);
+            const std::string out = format_with(num, c.spec);
+            if (out != c.expected)
+            {
+                std::printf("format_to {:%s} of %s: got \"%s\", expected \"%s\"\n", c.spec, c.value, out.c_str(), c.expected);
+                ok = false;
+            }
+#if defined(__cpp_lib_format)
+            const std::string formatted = std::vformat(std::string("{:") + c.spec + "}", std::make_format_args(num));
+            if (formatted != c.expected)
+            {
+                std::printf("std::format {:%s} of %s: got \"%s\", expected \"%s\"\n", c.spec, c.value, formatted.c_str(), c.expected);
+                ok = false;
+            }
+#endif
+        }
+        return ok;
+    }
+}
+
+int main()
+{
+    if (!check_format())
+        return 1;
+
+    std::mt19937_64 rng = bench::make_rng();
+    std::printf("%10s %8s %14s %14s %14s\n", "digits", "limbs", "from_str ms", "to_str ms", "to_chars ms");
+    for (const std::size_t digits : {100, 1000, 10000, 100000, 1000000, 4000000})
+    {
+        const std::string s = bench::random_digits(rng, digits);
+        const BigInt num(s);
+        std::string out;
+        std::string buf(digits + 1, '\0');
+        BigInt parsed;
+
+        const double parse = time_ms([&] { parsed = BigInt(s); });
+        const double format = time_ms([&] { out = num.to_str(); });
+        const double chars = time_ms([&] { num.to_chars(buf.data(), buf.data() + buf.size()); });
+        if (out != s || !(parsed == num))
+            std::printf("mismatch at %zu digits\n", digits);
+        std::printf("%10zu %8zu %14.3f %14.3f %14.3f\n", digits, num.get_limbs(), parse, format, chars);
+    }
+
+    std::printf("\n%10s %8s %14s %14s %14s %14s\n", "digits", "limbs", "to_str(16) ms", "to_bytes ms", "from_bytes ms", "to_wire ms");
+    for (const std::size_t digits : {100, 1000, 10000, 100000, 1000000})
+    {
+        const BigInt num(bench::random_digits(rng, digits));
+        std::vector<std::byte> bytes(num.get_limbs() * sizeof(BigInt::DataType) + 16);
+        std::string hex;
+        BigInt parsed;
+
+        const double format = time_ms([&] { hex = num.to_str(16); });
+        const std::size_t len = num.to_bytes(bytes);
+        const double save = time_ms([&] { num.to_bytes(bytes); });
+        const double load = time_ms([&] { parsed = BigInt::from_bytes(std::span<const std::byte>(bytes.data(), len)); });
+        const double wire = time_ms([&] { num.to_wire(bytes); });
+        if (!(parsed == num) || !(BigInt::from_str(hex, 16) == num))
+            std::printf("mismatch at %zu digits\n", digits);
+        std::printf("%10zu %8zu %14.3f %14.3f %14.3f %14.3f\n", digits, num.get_limbs(), format, save, load, wire);
+    }
+    return 0;
+}
@@ -1,24 +1,232 @@
-#include "bigint.h"
+#include "BigInt.h"
+#include "ModContext.h"
+#include "ScratchArena.h"
+#include "BigIntExpr.h"
+#include "TaskPool.h"
+#include <bit>
+#include <cstring>
+
+thread_local BigInt *BigInt::__mod_tar = nullptr;
+thread_local const ModContext *BigInt::__mod_ctx = nullptr;
+// inject_mod 建立的上下文; ModScope 的上下文由 ModScope 自己持有
+// ModScope 与 ModSuspend 期间之前的上下文移交给它们保存, 因此这里只有作用域内注入的上下文
+static thread_local std::unique_ptr<ModContext> injected_context;
+BigInt::Thresholds BigInt::thresholds;
+BigInt::Parallelism BigInt::parallelism;
+
+namespace
+{
+    // 进制转换在超过该 limb 数时分治, 否则逐块乘以 (除以) 单个 limb 能容纳的 base 的幂
+    constexpr std::size_t STR_DIVIDE_LIMBS = 40;
 
-BigInt *BigInt::__mod_tar = nullptr;
+    // 流式输出时每块的字符数
+    constexpr std::size_t STREAM_BLOCK = 4096;
 
-template <>
-struct std::formatter<BigInt>
-{
-    constexpr auto parse(std::format_parse_context &ctx) { return ctx.begin(); }
+    void to_upper(char *first, char *last)
+    {
+        for (char *it = first; it != last; ++it)
+        {
+            if (*it >= 'a' && *it <= 'z')
+                *it = static_cast<char>(*it - 'a' + 'A');
+        }
+    }
 
-    auto format(const BigInt &num, std::format_context &ctx) const { return std::format_to(ctx.out(), "{}", num.to_str()); }
-};
+    // 把 [first, last) 交给 sink, upper 时把字母转为大写
+    void emit_block(char *first, char *last, const bool upper, const BigInt::DigitSink sink, void *context)
+    {
+        if (upper)
+            to_upper(first, last);
+        sink(context, first, last - first);
+    }
+
+#if defined(BIGINT_BINARY_LIMBS)
+    // floor(n * log10(2)), log10(2) 取 128 位定点值, 误差小于 2^-64
+    std::size_t floor_log10_pow2(const std::size_t n)
+    {
+        const mpn::WideLimb low = static_cast<mpn::WideLimb>(n) * 0x47c4acd605be48bcull;
+        const mpn::WideLimb high = static_cast<mpn::WideLimb>(n) * 0x4d104d427de7fbccull + (low >> 64);
+        return static_cast<std::size_t>(high >> 64);
+    }
+#endif
+
+    // LEB128 编码的字节数: 每字节保存 7 位, 最高位表示后面还有字节
+    std::size_t varint_size(std::uint64_t value)
+    {
+        std::size_t size = 1;
+        for (; value >= 0x80; value >>= 7)
+            ++size;
+        return size;
+    }
+
+    // 当前线程正在执行的并行任务的嵌套层数
+    thread_local std::size_t task_depth = 0;
+
+    class TaskDepth
+    {
+    public:
+        explicit TaskDepth(const std::size_t depth) : saved(task_depth) { task_depth = depth; }
+        ~TaskDepth() { task_depth = this->saved; }
+
+    private:
+        std::size_t saved;
+    };
+
+    // 设置了 executor, 规模足够大且嵌套层数未超过限制时把各任务交给 executor 并等待完成, 否则在当前线程依次执行
+    template <typename... Tasks>
+    void run_tasks(const std::size_t limbs, const Tasks &...tasks)
+    {
+        const BigInt::Parallelism &parallelism = BigInt::get_parallelism();
+        if (parallelism.executor == nullptr || limbs < parallelism.min_limbs || task_depth >= parallelism.max_depth)
+        {
+            (tasks(), ...);
+            return;
+        }
+
+        // 任务可能在其他线程执行, 在任务内部记录嵌套层数
+        const std::size_t depth = task_depth + 1;
+        const auto wrap = [depth](const auto &task)
+        {
+            return std::function<void()>([&task, depth]
+                                         {
+                                             const TaskDepth scope(depth);
+                                             task();
+                                         });
+        };
+        const std::function<void()> list[] = {wrap(tasks)...};
+        parallelism.executor->fork_join(list);
+    }
+
+    // 三个 NTT 模数, 原根均为 3
+    constexpr std::uint32_t NTT_P1 = 998244353, NTT_P2 = 167772161, NTT_P3 = 469762049;
+    // 998244353 - 1 = 119 * 2^23, 变换长度不超过 2^23
+    constexpr std::size_t NTT_MAX_LOG = 23;
+
+    constexpr std::uint32_t limb_pow_mod(std::uint64_t base, std::uint64_t exp, const std::uint32_t mod)
+    {
+        std::uint64_t result = 1;
+        base %= mod;
+        while (exp != 0)
+        {
+            if (exp & 1)
+                result = result * base % mod;
+            base = base * base % mod;
+            exp >>= 1;
+        }
+        return static_cast<std::uint32_t>(result);
+    }
 
-BigInt::BigInt() : negative(false), data(std::vector<DataType>()) {}
+    template <std::uint32_t P>
+    void ntt(std::vector<std::uint32_t> &a, const bool invert)
+    {
+        const std::size_t n = a.size();
+        for (std::size_t i = 1, j = 0; i < n; ++i)
+        {
+            std::size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if (i < j)
+                std::swap(a[i], a[j]);
+        }
+
+        std::vector<std::uint32_t> roots(n / 2 + 1);
+        for (std::size_t len = 2; len <= n; len <<= 1)
+        {
+            const std::uint32_t root = limb_pow_mod(3, invert ? P - 1 - (P - 1) / len : (P - 1) / len, P);
+            const std::size_t half = len / 2;
+            roots[0] = 1;
+            for (std::size_t k = 1; k < half; ++k)
+                roots[k] = static_cast<std::uint64_t>(roots[k - 1]) * root % P;
+
+            for (std::size_t i = 0; i < n; i += len)
+            {
+                for (std::size_t k = 0; k < half; ++k)
+                {
+                    const std::uint32_t u = a[i + k];
+                    const std::uint32_t v = static_cast<std::uint64_t>(a[i + k + half]) * roots[k] % P;
+                    a[i + k] = (u + v >= P) ? u + v - P : u + v;
+                    a[i + k + half] = (u >= v) ? u - v : u + P - v;
+                }
+            }
+        }
+
+        if (invert)
+        {
+            const std::uint64_t n_inv = limb_pow_mod(n, P - 2, P);
+            for (auto &element : a)
+                element = element * n_inv % P;
+        }
+    }
+
+    // 模 P 下的循环卷积, 长度为 len (2 的幂)
+    // limbs 为较短操作数的 limb 数, 用于判断是否并行
+    template <std::uint32_t P>
+    std::vector<std::uint32_t> convolve(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b, const std::size_t len, const std::size_t limbs)
+    {
+        const auto transform = [len](const std::vector<std::uint32_t> &source, std::vector<std::uint32_t> &target)
+        {
+            target.assign(len, 0);
+            for (std::size_t i = 0; i < source.size(); ++i)
+                target[i] = source[i] % P;
+            ntt<P>(target, false);
+        };
+
+        std::vector<std::uint32_t> fa, fb;
+        // 平方只需一次正变换
+        if (&a == &b)
+        {
+            transform(a, fa);
+            for (auto &element : fa)
+                element = static_cast<std::uint64_t>(element) * element % P;
+        }
+        else
+        {
+            run_tasks(limbs, [&] { transform(a, fa); }, [&] { transform(b, fb); });
+            for (std::size_t i = 0; i < len; ++i)
+                fa[i] = static_cast<std::uint64_t>(fa[i]) * fb[i] % P;
+            // 逆变换前释放 fb, 降低峰值内存
+            std::vector<std::uint32_t>().swap(fb);
+        }
+        ntt<P>(fa, true);
+
+        return fa;
+    }
+}
+
+// a_len >= b_len, result 可以与 a 或 b 相同, 返回最高位进位
+BigInt::DataType BigInt::add_limbs(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len) { return mpn::add({result, a_len}, {a, a_len}, {b, b_len}); }
+
+// a_len >= b_len 且 a >= b, result 可以与 a 或 b 相同, 返回最高位借位
+BigInt::DataType BigInt::sub_limbs(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len) { return mpn::sub({result, a_len}, {a, a_len}, {b, b_len}); }
+
+BigInt::DataType BigInt::mul_limbs(DataType *result, const DataType *a, const std::size_t len, const DataType num) { return mpn::mul_1({result, len}, {a, len}, num); }
 
-BigInt::BigInt(bool negative, const std::vector<DataType> &data) : negative(negative), data(data) {}
+// result += a * num, 返回最高位进位
+BigInt::DataType BigInt::addmul_limbs(DataType *result, const DataType *a, const std::size_t len, const DataType num) { return mpn::addmul_1({result, len}, {a, len}, num); }
 
-BigInt::BigInt(bool negative, std::vector<DataType> &&data) : negative(negative), data(std::move(data)) {}
+// 返回余数
+BigInt::DataType BigInt::div_limbs(DataType *result, const DataType *a, const std::size_t len, const DataType num) { return mpn::divrem_1({result, len}, {a, len}, num); }
 
-BigInt::BigInt(bool negative, std::vector<DataType>::const_iterator begin, std::vector<DataType>::const_iterator end) : negative(negative), data(begin, end) {}
+BigInt::BigInt() : negative(false), data() {}
 
-BigInt::BigInt(bool negative, const uint32_t num) : negative(negative) { data.emplace_back(num); }
+BigInt::BigInt(bool negative, const std::vector<DataType> &data) : negative(negative), data(data.begin(), data.end()) { this->remove_front_zero(); }
+
+BigInt::BigInt(bool negative, std::vector<DataType> &&data) : negative(negative), data(data.begin(), data.end()) { this->remove_front_zero(); }
+
+BigInt::BigInt(bool negative, LimbVector &&data) : negative(negative), data(std::move(data)) { this->remove_front_zero(); }
+
+BigInt::BigInt(bool negative, std::vector<DataType>::const_iterator begin, std::vector<DataType>::const_iterator end) : negative(negative), data(begin, end) { this->remove_front_zero(); }
+
+BigInt::BigInt(bool negative, const uint32_t num) : negative(negative)
+{
+#if defined(BIGINT_BINARY_LIMBS)
+    data.emplace_back(num);
+#else
+    data.emplace_back(num % BigInt::LIMIT);
+    data.emplace_back(num / BigInt::LIMIT);
+#endif
+    this->remove_front_zero();
+}
 
 BigInt::BigInt(bool negative, std::initializer_list<DataType> list) : negative(negative)
 {
@@ -27,44 +235,23 @@ BigInt::BigInt(bool negative, std::initializer_list<DataType> list) : negative(n
     std::size_t cur_i = sz - 1;
     for (const auto element : list)
         data[cur_i--] = element;
+    this->remove_front_zero();
 }
 
 BigInt::BigInt(const std::string &s) : negative(false)
 {
-    std::string str = s;
-    if (s.front() == '-')
-    {
-        this->negative = true;
-        str.erase(0, 1);
-    }
-    // 去除前导零
-    std::size_t non_zero_pos = str.find_first_not_of('0');
-    if (non_zero_pos != std::string::npos)
-        str = str.substr(non_zero_pos);
-
-    const std::size_t len = str.length();
-    const std::size_t high_left = len % this->EXP;
-    const std::size_t counts = len / this->EXP;
-    const std::size_t data_size = counts + (high_left != 0);
-    this->data.resize(data_size);
-
-    std::size_t pos = 0;
-    if (high_left != 0)
-    {
-        this->data[data_size - 1] = static_cast<DataType>(std::stoull(str.substr(pos, high_left), nullptr));
-        pos += high_left;
-    }
-    for (std::size_t i = (high_left != 0); i < data_size; ++i)
-    {
-        this->data[data_size - 1 - i] = static_cast<DataType>(std::stoull(str.substr(pos, this->EXP), nullptr));
-        pos += this->EXP;
-    }
+    const char *last = s.data() + s.size();
+    const auto [ptr, ec] = BigInt::from_chars(s.data(), last, *this);
+    if (ec != std::errc() || ptr != last)
+        throw std::runtime_error("invalid number string");
 }
 
 BigInt::BigInt(const BigInt &other) : negative(other.negative), data(other.data) {}
 
 BigInt::BigInt(BigInt &&other) : negative(other.negative), data(std::move(other.data)) { other.negative = false; }
 
+BigInt::BigInt(BigIntView view) : negative(view.is_negative()), data(view.limbs().begin(), view.limbs().end()) {}
+
 bool BigInt::normal_equal(const BigInt &num) const
 {
     if (this->data.size() != num.data.size())
@@ -151,198 +338,121 @@ bool BigInt::is_zero() const
     return true;
 }
 
-std::size_t BigInt::get_digits() const
-{
-    if (this->is_zero())
-        return 1;
+std::size_t BigInt::get_limbs() const { return this->data.size(); }
 
-    return std::log10(this->data.back()) + 1 + this->EXP * (this->data.size() - 1);
+int BigInt::compare_abs(BigIntView a, BigIntView b)
+{
+    if (a.size() != b.size())
+        return (a.size() < b.size()) ? -1 : 1;
+    return mpn::cmp(a.limbs(), b.limbs());
 }
 
-BigInt BigInt::normal_add(const BigInt &num, const bool negative) const
+int BigInt::compare(BigIntView a, BigIntView b)
 {
-    BigInt result;
-    result.negative = negative;
-
-    std::uint8_t carry = 0;
-    const std::size_t either_len = this->data.size(), other_len = num.data.size();
-
-    std::size_t minlen = std::min(either_len, other_len);
-    result.data.resize(minlen);
-    for (std::size_t i = 0; i < minlen; ++i)
-    {
-        if (this->data[i] > this->LIMIT - num.data[i] - carry)
-        {
-            result.data[i] = static_cast<DataType>(this->data[i] + num.data[i] + carry - this->LIMIT);
-            carry = 1;
-        }
-        else
-        {
-            result.data[i] = static_cast<DataType>(this->data[i] + num.data[i] + carry);
-            carry = 0;
-        }
-    }
-
-    if (either_len == other_len && carry == 0)
-    {
+    if (a.is_negative() != b.is_negative())
+        return a.is_negative() ? -1 : 1;
+    const int result = BigInt::compare_abs(a, b);
+    return a.is_negative() ? -result : result;
+}
 
-        if (BigInt::__mod_tar != nullptr)
-            result %= *BigInt::__mod_tar;
-        return result;
-    }
+// 按绝对值的大小关系化为绝对值的加法或大减小
+BigInt BigInt::add(BigIntView a, BigIntView b)
+{
+    if (a.is_negative() == b.is_negative())
+        return BigInt::normal_add(a, b, a.is_negative());
+
+    const int order = BigInt::compare_abs(a, b);
+    if (order == 0)
+        return BigInt();
+    if (order > 0)
+        return BigInt::normal_substract(a, b, a.is_negative());
+    return BigInt::normal_substract(b, a, b.is_negative());
+}
 
-    if (either_len != other_len)
-    {
-        const auto &largerInt = (this->data.size() > num.data.size()) ? this->data : num.data;
-        const std::size_t len = largerInt.size();
-        result.data.resize(len);
-        for (std::size_t i = minlen; i < len; ++i)
-        {
-            result.data[i] = static_cast<DataType>(largerInt[i]) + carry;
-            carry = 0;
-            if (result.data[i] == 0)
-                carry = 1;
-        }
-        if (BigInt::__mod_tar != nullptr)
-            result %= *BigInt::__mod_tar;
-        return result;
-    }
+BigInt BigInt::normal_add(BigIntView a, BigIntView b, const bool negative)
+{
+    BIGINT_STATS_SCOPE(add, a.size() + b.size());
+    const std::span<const DataType> larger = (a.size() >= b.size()) ? a.limbs() : b.limbs();
+    const std::span<const DataType> smaller = (a.size() >= b.size()) ? b.limbs() : a.limbs();
 
-    result.data.emplace_back(static_cast<DataType>(carry));
+    BigInt result;
+    result.negative = negative;
+    result.data.resize(larger.size() + 1);
+    result.data[larger.size()] = BigInt::add_limbs(result.data.data(), larger.data(), larger.size(), smaller.data(), smaller.size());
+    result.remove_front_zero();
 
-    if (BigInt::__mod_tar != nullptr)
-        result %= *BigInt::__mod_tar;
+    result.mod_reduce();
 
     return result;
 }
 
-BigInt &BigInt::self_normal_add(const BigInt &num, const bool negative)
+// num 可以指向 *this 自身的 limb
+BigInt &BigInt::self_normal_add(BigIntView num, const bool negative)
 {
+    BIGINT_STATS_SCOPE(add, this->data.size() + num.size());
     this->negative = negative;
 
-    std::uint8_t carry = 0;
-    const std::size_t either_len = this->data.size(), other_len = num.data.size();
-
-    std::size_t minlen = std::min(either_len, other_len);
-    this->data.resize(minlen);
-    for (std::size_t i = 0; i < minlen; ++i)
-    {
-        if (this->data[i] > this->LIMIT - num.data[i] - carry)
-        {
-            this->data[i] = static_cast<DataType>(this->data[i] + num.data[i] + carry - this->LIMIT);
-            carry = 1;
-        }
-        else
-        {
-            this->data[i] = static_cast<DataType>(this->data[i] + num.data[i] + carry);
-            carry = 0;
-        }
-    }
-
-    if (either_len == other_len && carry == 0)
-    {
-        if (BigInt::__mod_tar != nullptr)
-            *this %= *BigInt::__mod_tar;
-        return *this;
-    }
-
-    if (either_len != other_len)
-    {
-        const auto &largerInt = (this->data.size() > num.data.size()) ? this->data : num.data;
-        const std::size_t len = largerInt.size();
-        this->data.resize(len);
-        for (std::size_t i = minlen; i < len; ++i)
-        {
-            this->data[i] = static_cast<DataType>(largerInt[i]) + carry;
-            carry = 0;
-            if (this->data[i] == 0)
-                carry = 1;
-        }
-        if (BigInt::__mod_tar != nullptr)
-            *this %= *BigInt::__mod_tar;
-        return *this;
-    }
+    if (this->data.size() < num.size())
+        this->data.resize(num.size());
 
-    this->data.emplace_back(static_cast<DataType>(carry));
+    const std::size_t len = this->data.size();
+    const DataType carry = BigInt::add_limbs(this->data.data(), this->data.data(), len, num.limbs().data(), num.size());
+    if (carry != 0)
+        this->data.emplace_back(carry);
 
-    if (BigInt::__mod_tar != nullptr)
-        *this %= *BigInt::__mod_tar;
+    this->mod_reduce();
 
     return *this;
 }
 
-BigInt BigInt::normal_substract(const BigInt &num, const bool negative) const
+// |a| - |b|, 要求 |a| >= |b|
+BigInt BigInt::normal_substract(BigIntView a, BigIntView b, const bool negative)
 {
-    BigInt result(*this);
+    BIGINT_STATS_SCOPE(sub, a.size() + b.size());
+    BigInt result;
     result.negative = negative;
+    result.data.resize(a.size());
 
-    const std::size_t len = num.data.size();
-    std::uint8_t borrow = 0;
-    for (std::size_t i = 0; i < len; ++i)
-    {
-        std::uint32_t left = num.data[i] + static_cast<DataType>(borrow);
-        if (result.data[i] < left)
-        {
-            borrow = 1;
-            result.data[i] += this->LIMIT - left;
-        }
-        else
-        {
-            borrow = 0;
-            result.data[i] -= left;
-        }
-    }
-    if (borrow == 1)
-        result.data[len] -= 1;
-
+    BigInt::sub_limbs(result.data.data(), a.limbs().data(), a.size(), b.limbs().data(), b.size());
     result.remove_front_zero();
 
-    if (BigInt::__mod_tar != nullptr)
-        result %= *BigInt::__mod_tar;
-
-    if (result.negative)
-        result = (result % *BigInt::__mod_tar + *BigInt::__mod_tar) % *BigInt::__mod_tar;
+    result.mod_reduce();
 
     return result;
 }
 
-BigInt &BigInt::self_normal_substract(const BigInt &num, const bool negative)
+BigInt &BigInt::self_normal_substract(BigIntView num, const bool negative)
 {
+    BIGINT_STATS_SCOPE(sub, this->data.size() + num.size());
     this->negative = negative;
 
-    const std::size_t len = num.data.size();
-    std::uint8_t borrow = 0;
-    for (std::size_t i = 0; i < len; ++i)
-    {
-        std::uint32_t left = num.data[i] + static_cast<DataType>(borrow);
-        if (this->data[i] < left)
-        {
-            borrow = 1;
-            this->data[i] += this->LIMIT - left;
-        }
-        else
-        {
-            borrow = 0;
-            this->data[i] -= left;
-        }
-    }
-    if (borrow == 1)
-        this->data[len] -= 1;
-
+    BigInt::sub_limbs(this->data.data(), this->data.data(), this->data.size(), num.limbs().data(), num.size());
     this->remove_front_zero();
 
-    if (BigInt::__mod_tar != nullptr)
-        *this %= *BigInt::__mod_tar;
+    this->mod_reduce();
 
-    if (this->negative)
-        *this = (*this % *BigInt::__mod_tar + *BigInt::__mod_tar) % *BigInt::__mod_tar;
+    return *this;
+}
+
+// *this = |num| - |*this|, 要求 |num| > |*this|
+BigInt &BigInt::self_reverse_substract(BigIntView num, const bool negative)
+{
+    BIGINT_STATS_SCOPE(sub, this->data.size() + num.size());
+    this->negative = negative;
+
+    const std::size_t prv_sz = this->data.size();
+    this->data.resize(num.size());
+    mpn::sub({this->data.data(), num.size()}, num.limbs(), {this->data.data(), prv_sz});
+    this->remove_front_zero();
+
+    this->mod_reduce();
 
     return *this;
 }
 
 void BigInt::chunk_move_left(const std::size_t sz)
 {
-    if (sz == 0)
+    if (sz == 0 || this->data.empty())
         return;
 
     const std::size_t prv_sz = this->data.size();
@@ -360,56 +470,54 @@ void BigInt::chunk_move_right(const std::size_t sz)
         return;
 
     const std::size_t prv_sz = this->data.size();
+    if (sz >= prv_sz)
+    {
+        this->data.clear();
+        return;
+    }
     for (std::size_t i = sz; i < prv_sz; ++i)
         this->data[i - sz] = this->data[i];
 
     this->data.resize(prv_sz - sz);
 }
 
-void BigInt::digit_move_left(const std::size_t sz)
+// 绝对值的 2^32 进制表示 (小端, 无前导零)
+std::vector<std::uint32_t> BigInt::binary_words() const
 {
-    this->chunk_move_left(sz / this->EXP);
-
-    const std::size_t left_sz = sz % this->EXP;
-    if (left_sz == 0)
-        return;
-
-    DataType carry = 0;
-    DataType ncarry = 0;
-    DataType divide_helper = std::pow(10, (this->EXP - left_sz));
-    DataType multi_helper = std::pow(10, left_sz);
-    for (auto &element : this->data)
+    std::vector<std::uint32_t> words;
+#if defined(BIGINT_BINARY_LIMBS)
+    words.reserve(2 * this->data.size());
+    for (const DataType limb : this->data)
     {
-        ncarry = (element / divide_helper);
-        element = (element * multi_helper) % this->LIMIT + carry;
-        carry = ncarry;
+        words.push_back(static_cast<std::uint32_t>(limb));
+        words.push_back(static_cast<std::uint32_t>(limb >> 32));
     }
-
-    if (carry != 0)
-        this->data.emplace_back(carry);
-}
-
-void BigInt::digit_move_right(const std::size_t sz)
-{
-    this->chunk_move_right(sz / this->EXP);
-
-    const std::size_t left_sz = sz % this->EXP;
-    if (left_sz == 0)
-        return;
-
-    DataType carry = 0;
-    DataType ncarry = 0;
-    DataType mod_divide_helper = std::pow(10, left_sz);
-    DataType multi_helper = std::pow(10, (this->EXP - left_sz));
-    for (auto it = this->data.rbegin(); it != this->data.rend(); ++it)
+#else
+    // 每次除以 2^16 取出低 16 位
+    LimbVector rest(this->data);
+    std::uint32_t word = 0;
+    unsigned shift = 0;
+    while (!rest.empty())
     {
-        ncarry = (*it % mod_divide_helper) * multi_helper;
-        *it = (*it / mod_divide_helper) + carry;
-        carry = ncarry;
-    }
+        const DataType low = BigInt::div_limbs(rest.data(), rest.data(), rest.size(), 1u << 16);
+        while (!rest.empty() && rest.back() == 0)
+            rest.pop_back();
 
-    if (this->data.back() == 0)
-        this->data.resize(this->data.size() - 1);
+        word |= static_cast<std::uint32_t>(low) << shift;
+        shift += 16;
+        if (shift == 32)
+        {
+            words.push_back(word);
+            word = 0;
+            shift = 0;
+        }
+    }
+    if (shift != 0)
+        words.push_back(word);
+#endif
+    while (!words.empty() && words.back() == 0)
+        words.pop_back();
+    return words;
 }
 
 void BigInt::remove_front_zero()
@@ -423,6 +531,8 @@ void BigInt::remove_front_zero()
     }
     if (zero_chunks != 0)
         this->data.resize(this->data.size() - zero_chunks);
+    if (this->data.empty())
+        this->negative = false;
 }
 
 BigInt &BigInt::operator=(const BigInt &other)
@@ -440,378 +550,977 @@ BigInt &BigInt::operator=(BigInt &&other)
     return *this;
 }
 
-BigInt BigInt::operator+(const BigInt &num) const
-{
-    if (this->negative == num.negative)
-        return this->normal_add(num, this->negative);
-
-    if (this->normal_equal(num))
-        return BigInt(std::string("0"));
-
-    if (!this->negative && num.negative)
-    {
-        if (this->normal_larger(num))
-            return this->normal_substract(num, false);
-
-        return num.normal_substract(*this, true);
-    }
+BigInt BigInt::operator+(const BigInt &num) const { return BigInt::add(*this, num); }
 
-    if (this->normal_larger(num))
-        return this->normal_substract(num, true);
+BigInt operator+(BigIntView a, BigIntView b) { return BigInt::add(a, b); }
 
-    return num.normal_substract(*this, false);
-}
+BigInt &BigInt::operator+=(const BigInt &num) { return *this += BigIntView(num); }
 
-BigInt &BigInt::operator+=(const BigInt &num)
+BigInt &BigInt::operator+=(BigIntView num)
 {
-    if (this->negative == num.negative)
+    if (this->negative == num.is_negative())
         return this->self_normal_add(num, this->negative);
 
-    if (this->normal_equal(num))
+    const int order = BigInt::compare_abs(*this, num);
+    if (order == 0)
     {
-        *this = BigInt(false, static_cast<uint32_t>(0));
+        this->data.clear();
+        this->negative = false;
         return *this;
     }
+    if (order > 0)
+        return this->self_normal_substract(num, this->negative);
+    return this->self_reverse_substract(num, num.is_negative());
+}
 
-    if (!this->negative && num.negative)
-    {
-        if (this->normal_larger(num))
-            return this->self_normal_substract(num, false);
+BigInt BigInt::operator-() const
+{
+    BigInt result(*this);
+    result.negative = !this->negative && !this->data.empty();
+    return result;
+}
 
-        *this = std::move(num.normal_substract(*this, true));
-        return *this;
-    }
+BigInt BigInt::operator-(const BigInt &num) const { return BigInt::add(*this, -BigIntView(num)); }
 
-    if (this->normal_larger(num))
-        return this->self_normal_substract(num, true);
+BigInt operator-(BigIntView a, BigIntView b) { return BigInt::add(a, -b); }
 
-    *this = std::move(num.normal_substract(*this, false));
-    return *this;
-}
+BigInt &BigInt::operator-=(const BigInt &num) { return *this += -BigIntView(num); }
 
-BigInt BigInt::operator-() const { return BigInt(!negative, data); }
+BigInt &BigInt::operator-=(BigIntView num) { return *this += -num; }
 
-BigInt BigInt::operator-(const BigInt &num) const
+// result 长度为 a_len + b_len, 不能与 a, b 重叠; a 与 b 为同一段内存时按平方计算
+void BigInt::mul_dispatch(DataType *result, const DataType *a, std::size_t a_len, const DataType *b, std::size_t b_len)
 {
-    if (*this == num)
-        return BigInt(false, static_cast<uint32_t>(0));
-
-    if (this->negative != num.negative)
-        return this->normal_add(num, this->negative);
-
-    if (!this->negative && !num.negative)
+    if (a_len < b_len)
     {
-        if (this->normal_larger(num))
-            return this->normal_substract(num, false);
-
-        return num.normal_substract(*this, true);
+        std::swap(a, b);
+        std::swap(a_len, b_len);
     }
 
-    if (this->normal_larger(num))
-        return this->normal_substract(num, true);
+    // Karatsuba 至少 4 个 limb, Toom-3 至少 12 个 limb, 保证递归规模严格减小
+    const Thresholds &limit = BigInt::thresholds;
+    if (b_len < std::max<std::size_t>(limit.karatsuba, 4))
+    {
+        if (a == b && a_len == b_len)
+            BigInt::sqr_basecase(result, a, a_len);
+        else
+            BigInt::mul_basecase(result, a, a_len, b, b_len);
+        return;
+    }
+    if (b_len >= limit.ntt && BigInt::ntt_fits(a_len, b_len))
+    {
+        BigInt::mul_ntt(result, a, a_len, b, b_len);
+        return;
+    }
+    if (2 * b_len <= a_len)
+    {
+        // 不平衡: 将 a 按 b_len 分块
+        std::fill(result, result + a_len + b_len, 0);
+        ScratchArena::Frame frame;
+        DataType *temp = frame.allocate(2 * b_len);
+        for (std::size_t offset = 0; offset < a_len; offset += b_len)
+        {
+            const std::size_t len = std::min(b_len, a_len - offset);
+            BigInt::mul_dispatch(temp, a + offset, len, b, b_len);
+            BigInt::add_limbs(result + offset, result + offset, a_len + b_len - offset, temp, len + b_len);
+        }
+        return;
+    }
+    if (b_len < std::max<std::size_t>(limit.toom3, 12))
+        BigInt::mul_karatsuba(result, a, a_len, b, b_len);
+    else
+        BigInt::mul_toom3(result, a, a_len, b, b_len);
+}
 
-    return num.normal_substract(*this, false);
+void BigInt::mul_basecase(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len)
+{
+    BIGINT_STATS_SCOPE(mul_basecase, a_len + b_len);
+    std::fill(result, result + a_len + b_len, 0);
+    for (std::size_t i = 0; i < b_len; ++i)
+        result[i + a_len] = BigInt::addmul_limbs(result + i, a, a_len, b[i]);
 }
 
-BigInt &BigInt::operator-=(const BigInt &num)
+// 交叉项 a[i] * a[j] (i < j) 只算一次再乘 2, 最后加上对角项 a[i]^2
+void BigInt::sqr_basecase(DataType *result, const DataType *a, const std::size_t len)
 {
-    if (*this == num)
+    BIGINT_STATS_SCOPE(mul_basecase, 2 * len);
+    std::fill(result, result + 2 * len, 0);
+    for (std::size_t i = 0; i + 1 < len; ++i)
+        result[i + len] = BigInt::addmul_limbs(result + 2 * i + 1, a + i + 1, len - i - 1, a[i]);
+
+    BigInt::add_limbs(result, result, 2 * len, result, 2 * len);
+
+    DataType carry = 0;
+    for (std::size_t i = 0; i < len; ++i)
     {
-        *this = BigInt(false, static_cast<uint32_t>(0));
-        return *this;
+        DataType high = 0;
+        const DataType low = mpn::mul_carry(a[i], a[i], high);
+        result[2 * i] = mpn::add_carry(result[2 * i], low, carry);
+        result[2 * i + 1] = mpn::add_carry(result[2 * i + 1], high, carry);
     }
+}
 
-    if (this->negative != num.negative)
-        return this->self_normal_add(num, this->negative);
+// a_len >= b_len > a_len / 2
+void BigInt::mul_karatsuba(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len)
+{
+    BIGINT_STATS_SCOPE(mul_karatsuba, a_len + b_len);
+    const std::size_t half = (a_len + 1) / 2;
+    const std::size_t a1_len = a_len - half, b1_len = b_len - half;
+    const std::size_t total = a_len + b_len;
 
-    if (!this->negative && !num.negative)
+    ScratchArena::Frame frame;
+    if (b1_len == 0)
     {
-        if (this->normal_larger(num))
-            return this->self_normal_substract(num, false);
-
-        *this = std::move(num.normal_substract(*this, true));
-        return *this;
+        DataType *temp = frame.allocate(a1_len + b_len);
+        run_tasks(
+            b_len, [=] { BigInt::mul_dispatch(result, a, half, b, b_len); },
+            [=] { BigInt::mul_dispatch(temp, a + half, a1_len, b, b_len); });
+        std::fill(result + half + b_len, result + total, 0);
+        BigInt::add_limbs(result + half, result + half, total - half, temp, a1_len + b_len);
+        return;
     }
 
-    if (this->normal_larger(num))
-        return this->self_normal_substract(num, true);
-
-    *this = std::move(num.normal_substract(*this, false));
-    return *this;
+    // (a0 + a1)(b0 + b1) - a0 b0 - a1 b1, 平方时三个子乘积都是平方
+    const bool square = (a == b && a_len == b_len);
+    const std::size_t middle_size = 2 * half + 2;
+    DataType *sum_a = frame.allocate(half + 1);
+    DataType *sum_b = square ? sum_a : frame.allocate(half + 1);
+    DataType *middle = frame.allocate(middle_size);
+    sum_a[half] = BigInt::add_limbs(sum_a, a, half, a + half, a1_len);
+    if (!square)
+        sum_b[half] = BigInt::add_limbs(sum_b, b, half, b + half, b1_len);
+
+    // 三个子乘积写入互不重叠的位置
+    run_tasks(
+        b_len, [=] { BigInt::mul_dispatch(result, a, half, b, half); },
+        [=] { BigInt::mul_dispatch(result + 2 * half, a + half, a1_len, b + half, b1_len); },
+        [=] { BigInt::mul_dispatch(middle, sum_a, half + 1, sum_b, half + 1); });
+
+    BigInt::sub_limbs(middle, middle, middle_size, result, 2 * half);
+    BigInt::sub_limbs(middle, middle, middle_size, result + 2 * half, a1_len + b1_len);
+
+    std::size_t middle_len = middle_size;
+    while (middle_len > 0 && middle[middle_len - 1] == 0)
+        --middle_len;
+    BigInt::add_limbs(result + half, result + half, total - half, middle, middle_len);
 }
 
-BigInt BigInt::operator*(const BigInt &num) const
+// Toom-Cook 3, 取值点 0, 1, -1, -2, inf (Bodrato 插值序列)
+void BigInt::mul_toom3(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len)
 {
-    const std::size_t chunks_A = this->data.size(), chunks_B = num.data.size();
-    // base
-    if (chunks_B == 0 || chunks_A == 0)
-        return BigInt(false, static_cast<uint32_t>(0));
-    if (chunks_B == 1)
+    BIGINT_STATS_SCOPE(mul_toom3, a_len + b_len);
+    const ModSuspend guard;
+
+    const std::size_t k = (a_len + 2) / 3;
+    const auto part = [k](const DataType *p, const std::size_t len, const std::size_t i)
     {
-        BigInt result(*this * static_cast<uint32_t>(num.data.front()));
-        result.negative = this->negative ^ num.negative;
-        return result;
-    }
-    if (chunks_A == 1)
+        const std::size_t begin = std::min(len, i * k), end = std::min(len, (i + 1) * k);
+        return BigInt(false, LimbVector(p + begin, p + end));
+    };
+    const auto evaluate = [&part](const DataType *p, const std::size_t len)
     {
-        BigInt result(num * static_cast<uint32_t>(this->data.front()));
-        result.negative = this->negative ^ num.negative;
-        return result;
+        const BigInt p0 = part(p, len, 0), p1 = part(p, len, 1), p2 = part(p, len, 2);
+        const BigInt sum = p0 + p2;
+        const BigInt at_m1 = sum - p1;
+        const BigInt at_m2 = lazy(at_m1) + at_m1 + p2 + p2 - p0;
+        return std::vector<BigInt>{p0, sum + p1, at_m1, at_m2, p2};
+    };
+
+    // 平方时只需对 a 求值, 五个点积都是平方
+    const bool square = (a == b && a_len == b_len);
+    const std::vector<BigInt> va = evaluate(a, a_len);
+    const std::vector<BigInt> vb = square ? std::vector<BigInt>() : evaluate(b, b_len);
+    const std::vector<BigInt> &vb_ref = square ? va : vb;
+
+    BigInt v0, v1, v_m1, v_m2, v_inf;
+    run_tasks(
+        b_len, [&] { v0 = BigInt::mul(va[0], vb_ref[0]); },
+        [&] { v1 = BigInt::mul(va[1], vb_ref[1]); },
+        [&] { v_m1 = BigInt::mul(va[2], vb_ref[2]); },
+        [&] { v_m2 = BigInt::mul(va[3], vb_ref[3]); },
+        [&] { v_inf = BigInt::mul(va[4], vb_ref[4]); });
+
+    BigInt r3 = (v_m2 - v1) / static_cast<uint32_t>(3);
+    BigInt r1 = (v1 - v_m1) / static_cast<uint32_t>(2);
+    BigInt r2 = v_m1 - v0;
+    r3 = lazy((r2 - r3) / static_cast<uint32_t>(2)) + v_inf + v_inf;
+    r2 = lazy(r2) + r1 - v_inf;
+    r1 = r1 - r3;
+
+    BigInt product(v_inf);
+    const BigInt *coefs[] = {&r3, &r2, &r1, &v0};
+    for (const BigInt *coef : coefs)
+    {
+        product.chunk_move_left(k);
+        product += *coef;
     }
 
-    const std::size_t mid = std::min(chunks_A, chunks_B) / 2;
-    // divide
-    BigInt b(false, this->data.begin(), this->data.begin() + mid), a(false, this->data.begin() + mid, this->data.end());
-    BigInt d(false, num.data.begin(), num.data.begin() + mid), c(false, num.data.begin() + mid, num.data.end());
-
-    auto temp2 = a * c;
-    const auto temp0 = b * d;
-    auto temp1 = (a + b) * (c + d) - temp2 - temp0;
-    temp2.chunk_move_left(mid * 2);
-    temp1.chunk_move_left(mid);
-
-    BigInt result(temp2 + temp1 + temp0);
-    result.negative = this->negative ^ num.negative;
-
-    if (BigInt::__mod_tar != nullptr)
-        result %= *BigInt::__mod_tar;
-
-    return result;
+    std::fill(result, result + a_len + b_len, 0);
+    std::copy(product.data.begin(), product.data.end(), result);
 }
 
-BigInt &BigInt::operator*=(const BigInt &num)
+bool BigInt::ntt_fits(const std::size_t a_len, const std::size_t b_len)
 {
-    *this = *this * num;
-    return *this;
+#if defined(BIGINT_BINARY_LIMBS)
+    // 每个 limb 拆成两个 32 位块, 卷积项 < 2^22 * 2^64, 不超过三模数之积
+    const std::size_t pieces = 2 * (a_len + b_len);
+    return pieces <= (static_cast<std::size_t>(1) << (NTT_MAX_LOG - 1));
+#else
+    return a_len + b_len <= (static_cast<std::size_t>(1) << NTT_MAX_LOG);
+#endif
 }
 
-BigInt BigInt::operator/(const BigInt &num) const
+// 三模数 NTT 卷积后用 Garner 算法合并
+void BigInt::mul_ntt(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len)
 {
-    if (num.is_zero())
-        throw std::runtime_error("divided by zero");
-
-    // 如果*this < num -> return 0;
-    if (*this < num)
-        return BigInt(false, 0);
-    if (*this == num)
-        return BigInt(false, 1);
-
-    BigInt origin(*this);
-    BigInt other(num);
-    BigInt result(false, std::move(std::vector<DataType>(this->data.size(), 0)));
-    other.digit_move_left(this->get_digits() - num.get_digits());
-
-    while (origin >= num)
+    BIGINT_STATS_SCOPE(mul_ntt, a_len + b_len);
+    const auto to_pieces = [](const DataType *p, const std::size_t len)
     {
-        std::uint_fast32_t count = 0;
-        while (origin >= other)
+#if defined(BIGINT_BINARY_LIMBS)
+        std::vector<std::uint32_t> pieces(2 * len);
+        for (std::size_t i = 0; i < len; ++i)
         {
-            count++;
-            origin -= other;
+            pieces[2 * i] = static_cast<std::uint32_t>(p[i]);
+            pieces[2 * i + 1] = static_cast<std::uint32_t>(p[i] >> 32);
         }
-
-        result.data[other.data.size() - 1] += (count * std::pow(10, (other.get_digits() - 1) % BigInt::EXP));
-        other.digit_move_right(1);
+        return pieces;
+#else
+        return std::vector<std::uint32_t>(p, p + len);
+#endif
+    };
+#if defined(BIGINT_BINARY_LIMBS)
+    const std::uint64_t piece_base = static_cast<std::uint64_t>(1) << 32;
+#else
+    const std::uint64_t piece_base = BigInt::LIMIT;
+#endif
+
+    const bool square = (a == b && a_len == b_len);
+    const std::vector<std::uint32_t> pa = to_pieces(a, a_len);
+    const std::vector<std::uint32_t> pb = square ? std::vector<std::uint32_t>() : to_pieces(b, b_len);
+    const std::vector<std::uint32_t> &pb_ref = square ? pa : pb;
+    const std::size_t out_len = pa.size() + pb_ref.size();
+    std::size_t len = 1;
+    while (len < out_len)
+        len <<= 1;
+
+    // 三个模数下的卷积互不依赖
+    std::vector<std::uint32_t> c1, c2, c3;
+    run_tasks(
+        b_len, [&] { c1 = convolve<NTT_P1>(pa, pb_ref, len, b_len); },
+        [&] { c2 = convolve<NTT_P2>(pa, pb_ref, len, b_len); },
+        [&] { c3 = convolve<NTT_P3>(pa, pb_ref, len, b_len); });
+
+    // x = r1 + p1 * (k2 + p2 * k3)
+    constexpr std::uint64_t inv_p1_p2 = limb_pow_mod(NTT_P1, NTT_P2 - 2, NTT_P2);
+    constexpr std::uint64_t inv_p1p2_p3 = limb_pow_mod(static_cast<std::uint64_t>(NTT_P1) * NTT_P2 % NTT_P3, NTT_P3 - 2, NTT_P3);
+    constexpr std::uint64_t p1_p3 = NTT_P1 % NTT_P3;
+
+    std::vector<std::uint64_t> pieces(out_len);
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < out_len; ++i)
+    {
+        const std::uint64_t r1 = c1[i], r2 = c2[i], r3 = c3[i];
+        const std::uint64_t k2 = (r2 + NTT_P2 - r1 % NTT_P2) % NTT_P2 * inv_p1_p2 % NTT_P2;
+        const std::uint64_t low = (r1 + p1_p3 * k2) % NTT_P3;
+        const std::uint64_t k3 = (r3 + NTT_P3 - low) % NTT_P3 * inv_p1p2_p3 % NTT_P3;
+        const std::uint64_t y = k2 + static_cast<std::uint64_t>(NTT_P2) * k3;
+
+        // p1 * y 可能超过 64 位, 拆成 y_high * piece_base + y_low 分两位累加
+        const std::uint64_t y_low = y % piece_base, y_high = y / piece_base;
+        const std::uint64_t cur = r1 + NTT_P1 * y_low + carry;
+        pieces[i] = cur % piece_base;
+        carry = cur / piece_base + NTT_P1 * y_high;
     }
 
-    result.remove_front_zero();
-    result.digit_move_right(num.get_digits() - 1);
+#if defined(BIGINT_BINARY_LIMBS)
+    for (std::size_t i = 0; i < a_len + b_len; ++i)
+        result[i] = pieces[2 * i] | (pieces[2 * i + 1] << 32);
+#else
+    std::copy(pieces.begin(), pieces.end(), result);
+#endif
+}
+
+// 不做模约化的乘法
+BigInt BigInt::mul(BigIntView a, BigIntView b)
+{
+    if (a.is_zero() || b.is_zero())
+        return BigInt();
+    BIGINT_STATS_SCOPE(mul, a.size() + b.size());
 
-    if (BigInt::__mod_tar != nullptr)
-        result %= *BigInt::__mod_tar;
+    // Karatsuba 各层的临时空间合计不超过约 4 (a_len + b_len) 个 limb
+    const std::size_t a_len = a.size(), b_len = b.size();
+    const bool scratch = std::min(a_len, b_len) >= BigInt::thresholds.karatsuba;
+    ScratchArena::Frame frame(scratch ? 4 * (a_len + b_len) + 64 : 0);
 
+    BigInt result;
+    result.data.resize(a_len + b_len);
+    BigInt::mul_dispatch(result.data.data(), a.limbs().data(), a_len, b.limbs().data(), b_len);
+    result.remove_front_zero();
+    result.negative = a.is_negative() ^ b.is_negative();
     return result;
 }
 
-BigInt &BigInt::operator/=(const BigInt &num)
+BigInt BigInt::operator*(const BigInt &num) const
 {
-    if (num.is_zero())
-        throw std::runtime_error("divided by zero");
+    if (&num == this)
+        return this->square();
 
-    // 如果*this < num -> return 0;
-    if (*this < num)
-    {
-        *this = BigInt(false, 0);
-        return *this;
-    }
-    if (*this == num)
+    BigInt result(BigInt::mul(*this, num));
+
+    result.mod_reduce();
+
+    return result;
+}
+
+BigInt &BigInt::operator*=(const BigInt &num)
+{
+    if (&num == this)
+        *this = this->square();
+    else
+        *this = *this * num;
+    return *this;
+}
+
+// 两个视图指向同一段 limb 时 mul_dispatch 按平方计算
+BigInt operator*(BigIntView a, BigIntView b)
+{
+    BigInt result(BigInt::mul(a, b));
+
+    result.mod_reduce();
+
+    return result;
+}
+
+BigInt &BigInt::operator*=(BigIntView num)
+{
+    *this = *this * num;
+    return *this;
+}
+
+// 同一对象相乘时 mul_dispatch 按平方计算
+BigInt BigInt::square() const
+{
+    BigInt result(BigInt::mul(*this, *this));
+
+    result.mod_reduce();
+
+    return result;
+}
+
+// |a| = |b| * quot + rem, 商向零截断, 余数与被除数同号
+void BigInt::normal_divmod(BigIntView a, BigIntView b, BigInt &quot, BigInt &rem)
+{
+    BIGINT_STATS_SCOPE(div, a.size() + b.size());
+    if (BigInt::compare_abs(a, b) < 0)
     {
-        *this = BigInt(false, 1);
-        return *this;
+        quot = BigInt();
+        rem = BigInt(a);
+        return;
     }
 
-    BigInt origin(*this);
-    BigInt other(num);
-    other.digit_move_left(origin.get_digits() - other.get_digits());
-    std::fill(this->data.begin(), this->data.end(), 0);
+    const std::size_t n = b.size();
+    const std::size_t m = a.size() - n;
+    const std::size_t limit = BigInt::thresholds.burnikel_ziegler;
+
+    if (n >= limit && m >= limit)
+        BigInt::recursive_divmod(a, b, quot, rem);
+    else
+        BigInt::knuth_divmod(a, b, quot, rem);
+
+    quot.negative = a.is_negative() ^ b.is_negative();
+    rem.negative = a.is_negative();
+    quot.remove_front_zero();
+    rem.remove_front_zero();
+}
 
-    while (origin >= num)
+// Knuth Algorithm D, 要求 |a| >= |b|
+void BigInt::knuth_divmod(BigIntView a, BigIntView b, BigInt &quot, BigInt &rem)
+{
+    BIGINT_STATS_SCOPE(div_knuth, a.size() + b.size());
+    quot = BigInt();
+    rem = BigInt();
+
+    const DataType *a_data = a.limbs().data(), *b_data = b.limbs().data();
+    const std::size_t n = b.size();
+    const std::size_t m = a.size() - n;
+
+    if (n == 1)
     {
-        std::uint_fast32_t count = 0;
-        while (origin >= other)
+        quot.data.resize(a.size());
+        const DataType r = BigInt::div_limbs(quot.data.data(), a_data, a.size(), b_data[0]);
+        rem.data.emplace_back(r);
+    }
+    else
+    {
+        // 归一化: 使除数最高 limb 不小于 LIMIT / 2, 保证商的估计最多偏大 2
+#if defined(BIGINT_BINARY_LIMBS)
+        const DataType scale = static_cast<DataType>(1) << __builtin_clzll(b_data[n - 1]);
+#else
+        const DataType scale = BigInt::LIMIT / (b_data[n - 1] + 1);
+#endif
+        ScratchArena::Frame frame(a.size() + n + 1);
+        DataType *u = frame.allocate(a.size() + 1);
+        DataType *v = frame.allocate(n);
+        u[a.size()] = BigInt::mul_limbs(u, a_data, a.size(), scale);
+        BigInt::mul_limbs(v, b_data, n, scale);
+        const DataType v_high = v[n - 1], v_next = v[n - 2];
+        quot.data.resize(m + 1);
+        for (std::size_t j = m + 1; j-- > 0;)
         {
-            count++;
-            origin -= other;
+#if defined(BIGINT_BINARY_LIMBS)
+            const WideType base = static_cast<WideType>(1) << BigInt::LIMB_BITS;
+#else
+            const WideType base = BigInt::LIMIT;
+#endif
+            const WideType top = static_cast<WideType>(u[j + n]) * base + u[j + n - 1];
+            WideType q_hat = top / v_high;
+            WideType r_hat = top % v_high;
+            while (q_hat >= base || q_hat * v_next > r_hat * base + u[j + n - 2])
+            {
+                --q_hat;
+                r_hat += v_high;
+                if (r_hat >= base)
+                    break;
+            }
+
+            // u[j..j+n] -= q_hat * v
+            DataType borrow = 0;
+            const DataType high = mpn::submul_1({u + j, n}, {v, n}, static_cast<DataType>(q_hat));
+            u[j + n] = mpn::sub_borrow(u[j + n], high, borrow);
+
+            // 估计偏大, 加回一次
+            if (borrow != 0)
+            {
+                --q_hat;
+                DataType carry = mpn::add_n({u + j, n}, {u + j, n}, {v, n});
+                u[j + n] = mpn::add_carry(u[j + n], 0, carry);
+            }
+
+            quot.data[j] = static_cast<DataType>(q_hat);
         }
 
-        this->data[other.data.size() - 1] += (count * std::pow(10, (other.get_digits() - 1) % BigInt::EXP));
-        other.digit_move_right(1);
+        rem.data.resize(n);
+        BigInt::div_limbs(rem.data.data(), u, n, scale);
     }
 
-    this->remove_front_zero();
-    this->digit_move_right(num.get_digits() - 1);
+    quot.remove_front_zero();
+    rem.remove_front_zero();
+}
 
-    if (BigInt::__mod_tar != nullptr)
-        *this %= *BigInt::__mod_tar;
+// Burnikel-Ziegler 递归除法, 要求 |a| >= |b|
+// 将被除数按除数长度 n 分块, 每块用 div_2n_1n 求商, 递归到 Knuth 除法为止
+void BigInt::recursive_divmod(BigIntView a, BigIntView b, BigInt &quot, BigInt &rem)
+{
+    BIGINT_STATS_SCOPE(div_burnikel_ziegler, a.size() + b.size());
+    // 递归过程中的中间结果不能被模数约化
+    const ModSuspend guard;
+
+#if defined(BIGINT_BINARY_LIMBS)
+    const DataType scale = static_cast<DataType>(1) << __builtin_clzll(b.limbs().back());
+#else
+    const DataType scale = BigInt::LIMIT / (b.limbs().back() + 1);
+#endif
+    BigInt a_norm, b_norm;
+    a_norm.data.resize(a.size() + 1);
+    a_norm.data[a.size()] = BigInt::mul_limbs(a_norm.data.data(), a.limbs().data(), a.size(), scale);
+    a_norm.remove_front_zero();
+    b_norm.data.resize(b.size());
+    BigInt::mul_limbs(b_norm.data.data(), b.limbs().data(), b.size(), scale);
+
+    const std::size_t n = b_norm.data.size();
+    const std::size_t chunks = (a_norm.data.size() + n - 1) / n;
+
+    BigInt result, r;
+    result.data.resize(chunks * n);
+    for (std::size_t i = chunks; i-- > 0;)
+    {
+        BigInt cur(r);
+        cur.chunk_move_left(n);
+        cur += BigIntView(a_norm).slice(i * n, (i + 1) * n);
+
+        BigInt q;
+        BigInt::div_2n_1n(cur, b_norm, n, q, r);
+        std::copy(q.data.begin(), q.data.end(), result.data.begin() + i * n);
+    }
+    result.remove_front_zero();
+
+    rem = BigInt();
+    rem.data.resize(r.data.size());
+    BigInt::div_limbs(rem.data.data(), r.data.data(), r.data.size(), scale);
+    rem.remove_front_zero();
+    quot = std::move(result);
+}
 
+// a < b * LIMIT^n, b 恰有 n 个 limb 且已归一化; 各部分以切片传递, 只在 n 为奇数时复制
+void BigInt::div_2n_1n(BigIntView a, BigIntView b, std::size_t n, BigInt &quot, BigInt &rem)
+{
+    if (BigInt::compare_abs(a, b) < 0)
+    {
+        quot = BigInt();
+        rem = BigInt(a);
+        return;
+    }
+    if (n < BigInt::thresholds.burnikel_ziegler)
+    {
+        BigInt::knuth_divmod(a, b, quot, rem);
+        return;
+    }
+
+    // n 为奇数时整体左移一个 limb
+    const bool pad = n & 1;
+    BigInt a_pad, b_pad;
+    if (pad)
+    {
+        a_pad = BigInt(a);
+        b_pad = BigInt(b);
+        a_pad.chunk_move_left(1);
+        b_pad.chunk_move_left(1);
+        a = a_pad;
+        b = b_pad;
+        ++n;
+    }
+
+    const std::size_t half = n / 2;
+    const BigIntView b1 = b.slice(half, n), b2 = b.slice(0, half);
+
+    BigInt q1, q2, r1;
+    BigInt::div_3n_2n(a.high(n), a.slice(half, n), b, b1, b2, half, q1, r1);
+    BigInt::div_3n_2n(r1, a.low(half), b, b1, b2, half, q2, rem);
+
+    if (pad)
+        rem.chunk_move_right(1);
+
+    q1.chunk_move_left(half);
+    quot = q1 + q2;
+}
+
+// [a12, a3] / [b1, b2], 其中 b1, b2, a3 各 n 个 limb
+void BigInt::div_3n_2n(BigIntView a12, BigIntView a3, BigIntView b, BigIntView b1, BigIntView b2, const std::size_t n, BigInt &quot, BigInt &rem)
+{
+    if (BigInt::compare_abs(a12.high(n), b1) == 0)
+    {
+        // 商的估计为 LIMIT^n - 1
+#if defined(BIGINT_BINARY_LIMBS)
+        quot = BigInt(false, LimbVector(n, ~static_cast<DataType>(0)));
+#else
+        quot = BigInt(false, LimbVector(n, BigInt::LIMIT - 1));
+#endif
+        BigInt shifted(b1);
+        shifted.chunk_move_left(n);
+        rem = a12 - shifted + b1;
+    }
+    else
+        BigInt::div_2n_1n(a12, b1, n, quot, rem);
+
+    rem.chunk_move_left(n);
+    rem += a3;
+    rem -= quot * b2;
+    while (rem.negative)
+    {
+        quot -= BigInt(false, static_cast<uint32_t>(1));
+        rem += b;
+    }
+}
+
+void BigInt::set_thresholds(const Thresholds &thresholds) { BigInt::thresholds = thresholds; }
+
+const BigInt::Thresholds &BigInt::get_thresholds() { return BigInt::thresholds; }
+
+void BigInt::set_parallelism(const Parallelism &parallelism) { BigInt::parallelism = parallelism; }
+
+const BigInt::Parallelism &BigInt::get_parallelism() { return BigInt::parallelism; }
+
+std::pair<BigInt, BigInt> BigInt::divmod(const BigInt &num) const
+{
+    if (num.is_zero())
+        throw std::runtime_error("divided by zero");
+
+    std::pair<BigInt, BigInt> result;
+    BigInt::normal_divmod(*this, num, result.first, result.second);
+
+    result.first.mod_reduce();
+
+    return result;
+}
+
+BigInt BigInt::operator/(const BigInt &num) const { return BigIntView(*this) / BigIntView(num); }
+
+BigInt operator/(BigIntView a, BigIntView b)
+{
+    if (b.is_zero())
+        throw std::runtime_error("divided by zero");
+
+    BigInt quot, rem;
+    BigInt::normal_divmod(a, b, quot, rem);
+
+    quot.mod_reduce();
+
+    return quot;
+}
+
+BigInt &BigInt::operator/=(const BigInt &num)
+{
+    *this = *this / num;
+    return *this;
+}
+
+BigInt &BigInt::operator/=(BigIntView num)
+{
+    *this = *this / num;
     return *this;
 }
 
-BigInt BigInt::operator%(const BigInt &num) const
+BigInt BigInt::operator%(const BigInt &num) const { return BigIntView(*this) % BigIntView(num); }
+
+BigInt operator%(BigIntView a, BigIntView b)
+{
+    if (b.is_zero())
+        throw std::runtime_error("mod by zero");
+
+    BigInt quot, rem;
+    BigInt::normal_divmod(a, b, quot, rem);
+
+    return rem;
+}
+
+BigInt &BigInt::operator%=(const BigInt &num) { return *this %= BigIntView(num); }
+
+BigInt &BigInt::operator%=(BigIntView num)
 {
     if (num.is_zero())
         throw std::runtime_error("mod by zero");
 
-    if (*this < num)
+    if (BigInt::compare_abs(*this, num) < 0)
         return *this;
-    if (*this == num)
-        return BigInt(false, static_cast<uint32_t>(0));
 
-    BigInt origin(*this);
-    BigInt other(num);
-    other.digit_move_left(this->get_digits() - num.get_digits());
+    BigInt quot, rem;
+    BigInt::normal_divmod(*this, num, quot, rem);
+    *this = std::move(rem);
+
+    return *this;
+}
 
-    while (origin >= num)
+BigInt BigInt::operator^(const BigInt &num) const
+{
+    if (const ModContext *mod_context = BigInt::mod_context(); mod_context != nullptr)
     {
-        std::uint_fast32_t count = 0;
-        while (origin >= other)
-        {
-            count++;
-            origin -= other;
-        }
+        const ModContext &context = *mod_context;
+        return context.from_residue(context.pow(context.to_residue(*this), num));
+    }
 
-        other.digit_move_right(1);
+    // 从高位到低位扫描指数的二进制位, 不做除法
+    const std::vector<std::uint32_t> words = num.binary_words();
+    BigInt result(false, static_cast<uint32_t>(1));
+    if (words.empty())
+        return result;
+
+    result = *this;
+    std::size_t i = words.size() * 32 - 1;
+    while (((words.back() >> (i % 32)) & 1) == 0)
+        --i;
+    while (i-- > 0)
+    {
+        result = result.square();
+        if (((words[i / 32] >> (i % 32)) & 1) == 1)
+            result = result * *this;
     }
 
-    return origin;
+    return result;
 }
 
-BigInt &BigInt::operator%=(const BigInt &num)
+BigInt BigInt::pow_mod(const BigInt &base, const BigInt &exp, const BigInt &mod, const bool constant_time)
 {
-    if (num.is_zero())
-        throw std::runtime_error("mod by zero");
+    const ModContext context(mod);
+    const BigInt residue = context.to_residue(base);
+    return context.from_residue(constant_time ? context.pow_ladder(residue, exp) : context.pow(residue, exp));
+}
 
-    if (*this < num)
-        return *this;
-    if (*this == num)
+BigInt BigInt::inverse() const
+{
+    if (BigInt::__mod_tar == nullptr)
+        throw std::runtime_error("no modulus injected");
+
+    return mod_inverse(*this, *BigInt::__mod_tar);
+}
+
+BigInt BigInt::from_int64(const std::int64_t num)
+{
+    std::uint64_t rest = (num < 0) ? 0 - static_cast<std::uint64_t>(num) : static_cast<std::uint64_t>(num);
+    LimbVector data;
+#if defined(BIGINT_BINARY_LIMBS)
+    data.push_back(rest);
+#else
+    while (rest != 0)
     {
-        *this = BigInt(false, static_cast<uint32_t>(0));
-        return *this;
+        data.push_back(static_cast<DataType>(rest % BigInt::LIMIT));
+        rest /= BigInt::LIMIT;
     }
+#endif
+    return BigInt(num < 0, std::move(data));
+}
 
-    BigInt other(num);
-    other.digit_move_left(this->get_digits() - num.get_digits());
+// Lehmer: 只用 a, b 的最高位部分 x, y 模拟若干步欧几里得算法, 得到的矩阵对 (a, b) 同样成立
+// 要求 a >= b >= 0, 无法得到有效的一步时返回 false
+bool BigInt::lehmer_matrix(const BigInt &a, const BigInt &b, GcdMatrix &matrix)
+{
+    const std::size_t n = a.data.size();
+    if (n < 2)
+        return false;
 
-    while (*this >= num)
+    const auto limb = [](const BigInt &num, const std::size_t i) -> WideType { return (i < num.data.size()) ? num.data[i] : 0; };
+#if defined(BIGINT_BINARY_LIMBS)
+    // 取 a 的最高 62 位, b 右移相同位数
+    const std::size_t shift = (n - 1) * BigInt::LIMB_BITS + std::bit_width(a.data.back()) - 62;
+    const std::size_t index = shift / BigInt::LIMB_BITS, offset = shift % BigInt::LIMB_BITS;
+    const auto top = [&](const BigInt &num) {
+        const WideType wide = (limb(num, index + 1) << BigInt::LIMB_BITS) | limb(num, index);
+        return static_cast<std::int64_t>(static_cast<std::uint64_t>(wide >> offset) & ((std::uint64_t(1) << 62) - 1));
+    };
+#else
+    // 取 a 的最高两个 limb (小于 10^18), b 取相同位置
+    const auto top = [&](const BigInt &num) { return static_cast<std::int64_t>(limb(num, n - 1) * BigInt::LIMIT + limb(num, n - 2)); };
+#endif
+    std::int64_t x = top(a), y = top(b);
+    std::int64_t A = 1, B = 0, C = 0, D = 1;
+    while (y + C > 0 && y + D > 0)
     {
-        std::uint_fast32_t count = 0;
-        while (*this >= other)
-        {
-            count++;
-            *this -= other;
-        }
+        // 两个边界给出的商相同时, 这一步的商对原数也成立 (Knuth 4.5.2 算法 L)
+        const std::int64_t q = (x + A) / (y + C);
+        if (q != (x + B) / (y + D))
+            break;
 
-        other.digit_move_right(1);
+        std::tie(A, C) = std::make_pair(C, A - q * C);
+        std::tie(B, D) = std::make_pair(D, B - q * D);
+        std::tie(x, y) = std::make_pair(y, x - q * y);
     }
 
-    return *this;
+    if (B == 0)
+        return false;
+
+    matrix = {BigInt::from_int64(A), BigInt::from_int64(B), BigInt::from_int64(C), BigInt::from_int64(D)};
+    return true;
 }
 
-BigInt BigInt::operator^(const BigInt &num) const
+// (x, y) = matrix * (x, y)
+void BigInt::apply_matrix(const GcdMatrix &matrix, BigInt &x, BigInt &y)
 {
-    if (num.is_zero())
-        return BigInt(false, 1);
+    BigInt new_x(BigInt::mul(matrix[0], x) + BigInt::mul(matrix[1], y));
+    y = BigInt::mul(matrix[2], x) + BigInt::mul(matrix[3], y);
+    x = std::move(new_x);
+}
 
-    BigInt result(false, static_cast<uint32_t>(1));
-    BigInt a(*this);
-    BigInt b(num);
-    BigInt helper(false, static_cast<uint32_t>(2));
-    while (!b.is_zero())
-    {
-        if ((b.data.front() & 0x1) == 1)
-            result *= a;
+// target = matrix * target
+void BigInt::apply_matrix(const GcdMatrix &matrix, GcdMatrix &target)
+{
+    BigInt::apply_matrix(matrix, target[0], target[2]);
+    BigInt::apply_matrix(matrix, target[1], target[3]);
+}
 
-        a *= a;
-        b /= helper;
+// 由高位部分得到的矩阵作用于完整的数后, 结果可能略为负数或大小颠倒, 这里恢复 a >= b >= 0
+// 变换仍是幺模的, 因此 gcd 与 track 的记录都保持正确
+void BigInt::gcd_normalize(BigInt &a, BigInt &b, GcdMatrix *track)
+{
+    if (a.negative)
+    {
+        a.negative = false;
+        if (track != nullptr)
+            (*track)[0] = -(*track)[0], (*track)[1] = -(*track)[1];
+    }
+    if (b.negative)
+    {
+        b.negative = false;
+        if (track != nullptr)
+            (*track)[2] = -(*track)[2], (*track)[3] = -(*track)[3];
     }
+    if (a.normal_smaller(b))
+    {
+        std::swap(a, b);
+        if (track != nullptr)
+            std::swap((*track)[0], (*track)[2]), std::swap((*track)[1], (*track)[3]);
+    }
+}
 
-    if (BigInt::__mod_tar != nullptr)
-        result %= *BigInt::__mod_tar;
+// 一步约化: 能用 Lehmer 时一次前进多步, 否则做一次带余除法
+void BigInt::gcd_step(BigInt &a, BigInt &b, GcdMatrix *track)
+{
+    GcdMatrix matrix;
+    if (BigInt::lehmer_matrix(a, b, matrix))
+    {
+        BigInt::apply_matrix(matrix, a, b);
+        if (track != nullptr)
+            BigInt::apply_matrix(matrix, *track);
+        return;
+    }
 
-    return result;
+    BigInt quot, rem;
+    BigInt::normal_divmod(a, b, quot, rem);
+    a = std::move(b);
+    b = std::move(rem);
+    if (track != nullptr)
+    {
+        BigInt row0((*track)[0] - BigInt::mul(quot, (*track)[2]));
+        BigInt row1((*track)[1] - BigInt::mul(quot, (*track)[3]));
+        std::swap((*track)[0], (*track)[2]);
+        std::swap((*track)[1], (*track)[3]);
+        (*track)[2] = std::move(row0);
+        (*track)[3] = std::move(row1);
+    }
 }
 
-BigInt BigInt::inverse() const
+// half-GCD: 返回矩阵 M, 使 M * (a, b) 中较小的数不超过 a 的一半长度
+// 先递归处理高半部分, 用快速乘法把矩阵作用到整个数上, 再对剩余部分递归一次
+BigInt::GcdMatrix BigInt::hgcd(BigIntView a, BigIntView b)
 {
-    BigInt r0 = *this, r1 = *BigInt::__mod_tar, r2(false, static_cast<uint32_t>(0)), r11(false, static_cast<uint32_t>(0)), q(false, static_cast<uint32_t>(0));
-    BigInt s0(false, static_cast<uint32_t>(1)), s1(false, static_cast<uint32_t>(0));
-    BigInt s00(false, static_cast<uint32_t>(0)), s11(false, static_cast<uint32_t>(0));
+    const BigInt one(false, static_cast<uint32_t>(1));
+    GcdMatrix matrix = {one, BigInt(), BigInt(), one};
+
+    const std::size_t n = a.size();
+    const std::size_t m = (n + 1) / 2;
+    if (b.size() <= m)
+        return matrix;
 
-    while (true)
+    BigInt x(a), y(b);
+    if (n >= BigInt::thresholds.hgcd)
     {
-        q = r0 / r1;
-        r2 = r0 % r1;
+        matrix = BigInt::hgcd(a.slice(m, n), b.slice(m, n));
+        BigInt::apply_matrix(matrix, x, y);
+        BigInt::gcd_normalize(x, y, &matrix);
 
-        if (r2.is_zero())
-            break;
+        if (y.data.size() > m)
+        {
+            BigInt::gcd_step(x, y, &matrix);
+
+            const std::size_t l = x.data.size();
+            if (y.data.size() > m && l <= 2 * m)
+            {
+                const std::size_t k = 2 * m - l;
+                GcdMatrix second = BigInt::hgcd(BigIntView(x).slice(k, l), BigIntView(y).slice(k, l));
+                BigInt::apply_matrix(second, x, y);
+                BigInt::gcd_normalize(x, y, &second);
+                BigInt::apply_matrix(second, matrix);
+            }
+        }
+    }
 
-        r0 = r1;
-        r1 = r2;
+    while (y.data.size() > m)
+        BigInt::gcd_step(x, y, &matrix);
 
-        s00 = s0;
-        s11 = s1;
+    return matrix;
+}
 
-        s0 = s11;
-        s1 = s00 - q * s11;
+// 对 a >= b >= 0 求 gcd, track 非空时累乘所有变换, 使 track * (a, b) = (gcd, 0)
+BigInt BigInt::gcd_reduce(BigInt a, BigInt b, GcdMatrix *track)
+{
+    while (!b.is_zero())
+    {
+        if (b.data.size() >= BigInt::thresholds.hgcd && 2 * b.data.size() > a.data.size() + 1)
+        {
+            const GcdMatrix matrix = BigInt::hgcd(a, b);
+            BigInt::apply_matrix(matrix, a, b);
+            if (track != nullptr)
+                BigInt::apply_matrix(matrix, *track);
+            BigInt::gcd_normalize(a, b, track);
+        }
+
+        if (!b.is_zero())
+            BigInt::gcd_step(a, b, track);
     }
+    return a;
+}
 
-    if (s1.negative)
-        s1 = (s1 % *BigInt::__mod_tar + *BigInt::__mod_tar) % *BigInt::__mod_tar;
+BigInt gcd(const BigInt &a, const BigInt &b)
+{
+    const BigInt::ModSuspend guard;
 
-    return s1;
+    BigInt x(a), y(b);
+    BigInt::gcd_normalize(x, y, nullptr);
+    return BigInt::gcd_reduce(std::move(x), std::move(y), nullptr);
 }
 
-BigInt BigInt::operator*(const std::uint32_t num) const
+std::tuple<BigInt, BigInt, BigInt> ext_gcd(const BigInt &a, const BigInt &b)
 {
-    if (num == 0)
-        return BigInt(false, static_cast<uint32_t>(0));
+    const BigInt::ModSuspend guard;
+
+    const BigInt one(false, static_cast<uint32_t>(1));
+    BigInt::GcdMatrix track = {one, BigInt(), BigInt(), one};
+    BigInt x(a), y(b);
+    x.negative = y.negative = false;
+    BigInt::gcd_normalize(x, y, &track);
+
+    BigInt g = BigInt::gcd_reduce(std::move(x), std::move(y), &track);
+    BigInt &u = track[0], &v = track[1];
+    if (a.negative)
+        u = -u;
+    if (b.negative)
+        v = -v;
+    return {std::move(g), std::move(u), std::move(v)};
+}
+
+BigInt mod_inverse(const BigInt &a, const BigInt &mod)
+{
+    if (mod.is_zero())
+        throw std::runtime_error("mod by zero");
+
+    const BigInt::ModSuspend guard;
+
+    BigInt m(mod);
+    m.negative = false;
+    BigInt quot, rem;
+    BigInt::normal_divmod(a, m, quot, rem);
+    if (rem.negative)
+        rem = rem + m;
+
+    // 只需要 rem 的系数, 即 track[1]
+    const BigInt one(false, static_cast<uint32_t>(1));
+    BigInt::GcdMatrix track = {one, BigInt(), BigInt(), one};
+    BigInt::gcd_normalize(m, rem, &track);
+    const BigInt g = BigInt::gcd_reduce(m, std::move(rem), &track);
+    if (g != one)
+        throw std::runtime_error("not invertible");
 
     BigInt result;
+    BigInt::normal_divmod(track[1], m, quot, result);
+    if (result.negative)
+        result = result + m;
+    return result;
+}
+
+std::vector<BigInt> batch_mod_inverse(const std::vector<BigInt> &values, const BigInt &mod)
+{
+    const ModContext context(mod);
 
-    uint32_t carry = 0;
-    uint64_t temp = 0;
+    std::vector<BigInt> residues;
+    residues.reserve(values.size());
+    for (const BigInt &value : values)
+        residues.push_back(context.to_residue(value));
 
-    const auto &data = this->data;
-    const auto LIMIT = this->LIMIT;
-    auto &rdata = result.data;
+    context.batch_inv(residues);
 
-    rdata.resize(data.size());
+    for (BigInt &residue : residues)
+        residue = context.from_residue(residue);
+    return residues;
+}
 
-    const std::size_t prv_sz = data.size();
-    for (std::size_t i = 0; i < prv_sz; ++i)
-    {
-        temp = data[i] * num + carry;
-        carry = temp / LIMIT;
-        rdata[i] = temp % LIMIT;
-    }
+BigInt BigInt::operator*(const std::uint32_t num) const
+{
+    if (num == 0)
+        return BigInt(false, static_cast<uint32_t>(0));
 
-    if (carry != 0)
-        rdata.emplace_back(carry);
+#if !defined(BIGINT_BINARY_LIMBS)
+    if (num >= BigInt::LIMIT)
+        return *this * BigInt(false, num);
+#endif
+
+    BigInt result;
+
+    const std::size_t prv_sz = this->data.size();
+    result.data.resize(prv_sz + 1);
+    result.data[prv_sz] = BigInt::mul_limbs(result.data.data(), this->data.data(), prv_sz, num);
+    result.remove_front_zero();
 
     result.negative = this->negative;
 
-    if (BigInt::__mod_tar != nullptr)
-        result %= *BigInt::__mod_tar;
+    result.mod_reduce();
 
     return result;
 }
@@ -833,44 +1542,862 @@ BigInt BigInt::operator/=(const uint32_t number)
     return *this;
 }
 
-void BigInt::inject_mod(BigInt *mod_tar) { BigInt::__mod_tar = mod_tar; }
+// 注入模数后, 当前线程中各运算的结果通过预计算的 ModContext 做 Barrett 约化
+void BigInt::inject_mod(BigInt *mod_tar)
+{
+    BigInt::__mod_tar = nullptr;
+    BigInt::__mod_ctx = nullptr;
+    injected_context = (mod_tar != nullptr) ? std::make_unique<ModContext>(*mod_tar) : nullptr;
+    BigInt::__mod_tar = mod_tar;
+    BigInt::__mod_ctx = injected_context.get();
+}
 
-BigInt BigInt::from_str(const std::string &s) { return BigInt(s); }
+// inject_mod 只保存指针, 调用方之后可能修改 *__mod_tar; 与上下文中的模数不同时重新建立上下文
+const ModContext *BigInt::mod_context()
+{
+    if (BigInt::__mod_ctx == nullptr || BigInt::__mod_ctx != injected_context.get())
+        return BigInt::__mod_ctx;
 
-std::string BigInt::to_str() const
+    if (BigInt::compare_abs(injected_context->get_mod(), *BigInt::__mod_tar) != 0)
+    {
+        BigInt *mod_tar = BigInt::__mod_tar;
+        BigInt::inject_mod(mod_tar);
+    }
+    return BigInt::__mod_ctx;
+}
+
+// 作用域内 injected_context 为空, 之前注入的上下文由作用域持有, 析构时交还
+BigInt::ModScope::ModScope(const BigInt &mod)
+    : mod(mod), context(std::make_unique<ModContext>(mod)), saved(BigInt::__mod_tar), saved_ctx(BigInt::__mod_ctx), saved_owner(std::move(injected_context))
 {
-    if (this->data.empty())
-        return std::string("0");
+    BigInt::__mod_tar = &this->mod;
+    BigInt::__mod_ctx = this->context.get();
+}
 
-    std::string s;
-    if (this->negative)
-        s += '-';
+BigInt::ModScope::~ModScope()
+{
+    BigInt::__mod_tar = this->saved;
+    BigInt::__mod_ctx = this->saved_ctx;
+    injected_context = std::move(this->saved_owner);
+}
 
-    s += std::to_string(*this->data.rbegin());
-    if (this->data.size() == 1)
-        return s;
+BigInt::ModSuspend::ModSuspend() : saved(BigInt::__mod_tar), saved_ctx(BigInt::__mod_ctx), saved_owner(std::move(injected_context))
+{
+    BigInt::__mod_tar = nullptr;
+    BigInt::__mod_ctx = nullptr;
+}
 
-    for (auto it = this->data.rbegin() + 1; it != this->data.rend(); ++it)
+BigInt::ModSuspend::~ModSuspend()
+{
+    BigInt::__mod_tar = this->saved;
+    BigInt::__mod_ctx = this->saved_ctx;
+    injected_context = std::move(this->saved_owner);
+}
+
+// 将结果约化到 [0, mod)
+void BigInt::mod_reduce()
+{
+    if (const ModContext *context = BigInt::mod_context(); context != nullptr)
+    {
+        BIGINT_STATS_SCOPE(mod_reduce, this->data.size());
+        *this = context->reduce(*this);
+    }
+}
+
+// 按 base 进制转换时的常量, 参考 GMP 的 mp_bases
+struct BigInt::Radix
+{
+    // base 取 2 ~ 36, 否则抛出异常
+    static const Radix &get(const int base);
+    // 字节序列, 即每位直接保存数值的 256 进制
+    static const Radix &bytes();
+    // 下标 0 为字节序列, 其余为对应的 base
+    static const Radix &slot(const std::size_t index);
+
+    char digit(const unsigned value) const { return this->raw ? static_cast<char>(value) : "0123456789abcdefghijklmnopqrstuvwxyz"[value]; }
+    // 不是数字时返回的值不小于 base
+    unsigned value(const char c) const;
+
+    // 以 end 结尾写入 width 位, 不足时补零, 返回写入的起点
+    char *write_padded(char *end, DataType chunk, const std::size_t width) const
+    {
+        // 十进制时除数为常量, 除法会被编译为乘法
+        if (this->base == 10)
+        {
+            for (std::size_t i = 0; i < width; ++i, chunk /= 10)
+                *--end = static_cast<char>('0' + chunk % 10);
+            return end;
+        }
+
+        for (std::size_t i = 0; i < width; ++i, chunk /= this->base)
+            *--end = this->digit(static_cast<unsigned>(chunk % this->base));
+        return end;
+    }
+    // chunks 为 chunk_base 进制的块, 低位在前; width 为 0 时不写前导零, 否则补零到 width 位
+    char *write_chunks(char *out, const DataType *chunks, std::size_t count, const std::size_t width) const;
+    DataType read_chunk(const char *first, const char *last) const;
+
+    // powers[k] = chunk_base^(2^k), 按线程缓存
+    const std::vector<BigInt> &powers(const std::size_t levels) const;
+
+    unsigned base;
+    // base 为 2 的幂时每位的比特数, 否则为 0
+    unsigned bits;
+    // chunk_base = base^chunk_digits 是单个 limb 能容纳的最大的幂, 十进制 limb 下不超过 10^9
+    std::size_t chunk_digits;
+    DataType chunk_base;
+    bool raw;
+};
+
+namespace
+{
+    constexpr std::size_t RADIX_SLOTS = 37;
+}
+
+const BigInt::Radix &BigInt::Radix::get(const int base)
+{
+    if (base < 2 || base > 36)
+        throw std::runtime_error("invalid base");
+    return Radix::slot(base);
+}
+
+const BigInt::Radix &BigInt::Radix::bytes() { return Radix::slot(0); }
+
+const BigInt::Radix &BigInt::Radix::slot(const std::size_t index)
+{
+    static const std::array<Radix, RADIX_SLOTS> table = []
+    {
+        std::array<Radix, RADIX_SLOTS> table{};
+#if defined(BIGINT_BINARY_LIMBS)
+        const DataType max = std::numeric_limits<DataType>::max();
+#else
+        const DataType max = mpn::LIMIT;
+#endif
+        for (std::size_t slot = 0; slot < RADIX_SLOTS; ++slot)
+        {
+            Radix &radix = table[slot];
+            radix.raw = slot == 0;
+            radix.base = radix.raw ? 256 : std::max<unsigned>(slot, 2);
+            radix.bits = std::has_single_bit(radix.base) ? std::countr_zero(radix.base) : 0;
+            radix.chunk_digits = 1;
+            radix.chunk_base = radix.base;
+            while (radix.chunk_base <= max / radix.base)
+            {
+                radix.chunk_base *= radix.base;
+                ++radix.chunk_digits;
+            }
+        }
+        return table;
+    }();
+    return table[index];
+}
+
+unsigned BigInt::Radix::value(const char c) const
+{
+    if (this->raw)
+        return static_cast<unsigned char>(c);
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+    return this->base;
+}
+
+char *BigInt::Radix::write_chunks(char *out, const DataType *chunks, std::size_t count, const std::size_t width) const
+{
+    if (width == 0 && count != 0)
     {
-        std::string str = std::to_string(*it);
-        int zeros = 9 - str.length();
-        s += std::string(zeros, '0') + str;
+        const DataType top = chunks[--count];
+        if (!this->raw)
+            out = std::to_chars(out, out + this->chunk_digits, top, this->base).ptr;
+        else
+        {
+            std::size_t len = 0;
+            for (DataType rest = top; rest != 0; rest /= this->base)
+                ++len;
+            out += len;
+            this->write_padded(out, top, len);
+        }
     }
 
+    char *end = out + ((width == 0) ? count * this->chunk_digits : width);
+    char *pos = end;
+    for (std::size_t i = 0; i < count && pos != out; ++i)
+        pos = this->write_padded(pos, chunks[i], std::min<std::size_t>(this->chunk_digits, pos - out));
+    std::fill(out, pos, this->digit(0));
+    return end;
+}
+
+BigInt::DataType BigInt::Radix::read_chunk(const char *first, const char *last) const
+{
+    DataType chunk = 0;
+    if (!this->raw)
+        std::from_chars(first, last, chunk, this->base);
+    else
+    {
+        for (; first != last; ++first)
+            chunk = chunk * this->base + static_cast<unsigned char>(*first);
+    }
+    return chunk;
+}
+
+const std::vector<BigInt> &BigInt::Radix::powers(const std::size_t levels) const
+{
+    static thread_local std::array<std::vector<BigInt>, RADIX_SLOTS> cache;
+    std::vector<BigInt> &powers = cache[this->raw ? 0 : this->base];
+    if (powers.empty())
+        powers.push_back(BigInt(false, {this->chunk_base}));
+    while (powers.size() < levels)
+        powers.push_back(BigInt::mul(powers.back(), powers.back()));
+    return powers;
+}
+
+BigInt BigInt::from_str(const std::string &s, const int base)
+{
+    BigInt result;
+    const char *last = s.data() + s.size();
+    const auto [ptr, ec] = BigInt::from_chars(s.data(), last, result, base);
+    if (ec != std::errc() || ptr != last)
+        throw std::runtime_error("invalid number string");
+    return result;
+}
+
+std::string BigInt::to_str(const int base) const
+{
+    const Radix &radix = Radix::get(base);
+    std::string s(this->negative + this->max_digits(radix), '0');
+    char *out = s.data();
+    if (this->negative)
+        *out++ = '-';
+    s.resize(this->write_digits(out, radix) - s.data());
     return s;
 }
 
+std::from_chars_result BigInt::from_chars(const char *first, const char *last, BigInt &value, const int base)
+{
+    const Radix &radix = Radix::get(base);
+    const bool negative = first != last && *first == '-';
+    const char *begin = first + negative;
+    const char *end = (base == 10) ? std::find_if_not(begin, last, [](const char c) { return c >= '0' && c <= '9'; })
+                                   : std::find_if_not(begin, last, [&radix](const char c) { return radix.value(c) < radix.base; });
+    if (begin == end)
+        return {first, std::errc::invalid_argument};
+
+    // 去除前导零
+    BIGINT_STATS_SCOPE(parse, 0);
+    begin = std::find_if(begin, end, [](const char c) { return c != '0'; });
+    value = BigInt::parse_digits(begin, end - begin, radix);
+    BIGINT_STATS_LIMBS(value.data.size());
+    value.negative = negative && !value.data.empty();
+    return {end, std::errc()};
+}
+
+std::to_chars_result BigInt::to_chars(char *first, char *last, const int base) const
+{
+    const Radix &radix = Radix::get(base);
+    if (static_cast<std::size_t>(last - first) >= this->negative + this->max_digits(radix))
+    {
+        if (this->negative)
+            *first++ = '-';
+        return {this->write_digits(first, radix), std::errc()};
+    }
+
+    // 位数的上界可能多出一两位, 空间不足上界时先转换再复制
+    const std::string s = this->to_str(base);
+    if (s.size() > static_cast<std::size_t>(last - first))
+        return {last, std::errc::value_too_large};
+    return {std::copy(s.begin(), s.end(), first), std::errc()};
+}
+
+std::size_t BigInt::byte_size() const
+{
+#if defined(BIGINT_BINARY_LIMBS)
+    if (this->data.empty())
+        return 0;
+    return (this->LIMB_BITS * (this->data.size() - 1) + std::bit_width(this->data.back()) + 7) / 8;
+#else
+    return this->to_bytes().size();
+#endif
+}
+
+std::size_t BigInt::to_bytes(std::span<std::byte> out, const std::endian order) const
+{
+    if (this->data.empty())
+        return 0;
+
+#if defined(BIGINT_BINARY_LIMBS)
+    const std::size_t len = this->byte_size();
+    if (out.size() < len)
+        throw std::runtime_error("byte buffer too small");
+    // 完整的 limb 按需交换字节序后整块复制, 最高的不完整 limb 逐字节写入
+    const std::size_t full = len / sizeof(DataType);
+    for (std::size_t i = 0; i < full; ++i)
+    {
+        const DataType limb = (order == std::endian::native) ? this->data[i] : __builtin_bswap64(this->data[i]);
+        std::memcpy(out.data() + ((order == std::endian::little) ? i * sizeof(DataType) : len - (i + 1) * sizeof(DataType)), &limb, sizeof(DataType));
+    }
+    for (std::size_t i = full * sizeof(DataType); i < len; ++i)
+        out[(order == std::endian::little) ? i : len - 1 - i] = static_cast<std::byte>(this->data[i / sizeof(DataType)] >> (8 * (i % sizeof(DataType))));
+#else
+    // 十进制 limb 先按 256 进制转换为大端序
+    const Radix &radix = Radix::bytes();
+    char *first = reinterpret_cast<char *>(out.data());
+    std::size_t len = 0;
+    if (out.size() >= this->max_digits(radix))
+        len = this->write_digits(first, radix) - first;
+    else
+    {
+        std::string buffer(this->max_digits(radix), '\0');
+        len = this->write_digits(buffer.data(), radix) - buffer.data();
+        if (out.size() < len)
+            throw std::runtime_error("byte buffer too small");
+        std::copy(buffer.begin(), buffer.begin() + len, first);
+    }
+    if (order == std::endian::little)
+        std::reverse(first, first + len);
+#endif
+    return len;
+}
+
+std::vector<std::byte> BigInt::to_bytes(const std::endian order) const
+{
+    // 十进制 limb 的值小于 2^32, 两种进制下每个 limb 都至多占 sizeof(DataType) 个字节
+    std::vector<std::byte> bytes(this->data.size() * sizeof(DataType));
+    bytes.resize(this->to_bytes(bytes, order));
+    return bytes;
+}
+
+BigInt BigInt::from_bytes(std::span<const std::byte> bytes, const std::endian order)
+{
+    BigInt result;
+#if defined(BIGINT_BINARY_LIMBS)
+    const std::size_t len = bytes.size(), full = len / sizeof(DataType);
+    result.data.resize((len + sizeof(DataType) - 1) / sizeof(DataType));
+    for (std::size_t i = 0; i < full; ++i)
+    {
+        DataType limb;
+        std::memcpy(&limb, bytes.data() + ((order == std::endian::little) ? i * sizeof(DataType) : len - (i + 1) * sizeof(DataType)), sizeof(DataType));
+        result.data[i] = (order == std::endian::native) ? limb : __builtin_bswap64(limb);
+    }
+    for (std::size_t i = full * sizeof(DataType); i < len; ++i)
+    {
+        const std::byte byte = bytes[(order == std::endian::little) ? i : len - 1 - i];
+        result.data[i / sizeof(DataType)] |= std::to_integer<DataType>(byte) << (8 * (i % sizeof(DataType)));
+    }
+    result.remove_front_zero();
+#else
+    BIGINT_STATS_SCOPE(parse, 0);
+    const char *digits = reinterpret_cast<const char *>(bytes.data());
+    if (order == std::endian::little)
+    {
+        const std::string reversed(std::make_reverse_iterator(digits + bytes.size()), std::make_reverse_iterator(digits));
+        result = BigInt::parse_digits(reversed.data(), reversed.size(), Radix::bytes());
+    }
+    else
+        result = BigInt::parse_digits(digits, bytes.size(), Radix::bytes());
+    BIGINT_STATS_LIMBS(result.data.size());
+#endif
+    return result;
+}
+
+std::size_t BigInt::wire_size() const
+{
+    const std::size_t len = this->byte_size();
+    return varint_size((static_cast<std::uint64_t>(len) << 1) | this->negative) + len;
+}
+
+std::size_t BigInt::to_wire(std::span<std::byte> out) const
+{
+#if defined(BIGINT_BINARY_LIMBS)
+    const std::size_t len = this->byte_size();
+#else
+    // 十进制 limb 只做一次进制转换
+    const std::vector<std::byte> bytes = this->to_bytes(std::endian::little);
+    const std::size_t len = bytes.size();
+#endif
+    std::uint64_t header = (static_cast<std::uint64_t>(len) << 1) | this->negative;
+    const std::size_t head = varint_size(header);
+    if (out.size() < head + len)
+        throw std::runtime_error("byte buffer too small");
+
+    for (std::size_t i = 0; i < head; ++i, header >>= 7)
+        out[i] = static_cast<std::byte>((header & 0x7f) | ((i + 1 < head) ? 0x80 : 0));
+#if defined(BIGINT_BINARY_LIMBS)
+    this->to_bytes(out.subspan(head, len), std::endian::little);
+#else
+    std::copy(bytes.begin(), bytes.end(), out.begin() + head);
+#endif
+    return head + len;
+}
+
+std::vector<std::byte> BigInt::to_wire() const
+{
+    const std::size_t max_len = this->data.size() * sizeof(DataType);
+    std::vector<std::byte> out(varint_size((static_cast<std::uint64_t>(max_len) << 1) | 1) + max_len);
+    out.resize(this->to_wire(out));
+    return out;
+}
+
+std::size_t BigInt::from_wire(std::span<const std::byte> in, BigInt &value)
+{
+    std::uint64_t header = 0;
+    std::size_t head = 0;
+    for (unsigned shift = 0;; shift += 7)
+    {
+        if (head == in.size() || shift >= 64)
+            throw std::runtime_error("invalid wire data");
+        const std::uint64_t byte = std::to_integer<std::uint64_t>(in[head++]);
+        header |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            break;
+    }
+
+    const std::uint64_t len = header >> 1;
+    if (len > in.size() - head)
+        throw std::runtime_error("invalid wire data");
+    value = BigInt::from_bytes(in.subspan(head, len), std::endian::little);
+    value.negative = (header & 1) != 0 && !value.data.empty();
+    return head + len;
+}
+
+BigInt BigInt::parse_digits(const char *digits, const std::size_t len, const Radix &radix)
+{
+    BigInt result;
+#if defined(BIGINT_BINARY_LIMBS)
+    if (radix.bits != 0)
+    {
+        // 2 的幂进制直接按比特拼接, 最低位在字符串末尾
+        result.data.resize((len * radix.bits + BigInt::LIMB_BITS - 1) / BigInt::LIMB_BITS);
+        for (std::size_t i = 0; i < len; ++i)
+        {
+            const DataType value = radix.value(digits[len - 1 - i]);
+            const std::size_t pos = i * radix.bits, limb = pos / BigInt::LIMB_BITS, shift = pos % BigInt::LIMB_BITS;
+            result.data[limb] |= value << shift;
+            if (shift + radix.bits > BigInt::LIMB_BITS)
+                result.data[limb + 1] |= value >> (BigInt::LIMB_BITS - shift);
+        }
+        result.remove_front_zero();
+        return result;
+    }
+#else
+    if (!radix.raw && radix.base == 10)
+    {
+        // 从低位开始每 EXP 位对应一个 limb
+        result.data.resize((len + BigInt::EXP - 1) / BigInt::EXP);
+        const char *end = digits + len;
+        for (auto &element : result.data)
+        {
+            const char *begin = (end - digits > BigInt::EXP) ? end - BigInt::EXP : digits;
+            std::from_chars(begin, end, element);
+            end = begin;
+        }
+        result.remove_front_zero();
+        return result;
+    }
+#endif
+
+    if (len > radix.chunk_digits * STR_DIVIDE_LIMBS)
+    {
+        // 低位取 chunk_digits * 2^k 位 (k 为使其短于 len 的最大值), result = high * chunk_base^(2^k) + low
+        std::size_t level = 0;
+        while ((radix.chunk_digits << (level + 1)) < len)
+            ++level;
+        const std::size_t low_len = radix.chunk_digits << level;
+        const BigInt high = BigInt::parse_digits(digits, len - low_len, radix);
+        const BigInt low = BigInt::parse_digits(digits + len - low_len, low_len, radix);
+
+        result = BigInt::mul(high, radix.powers(level + 1)[level]);
+        result.data.resize(std::max(result.data.size(), low.data.size()) + 1);
+        BigInt::add_limbs(result.data.data(), result.data.data(), result.data.size(), low.data.data(), low.data.size());
+        result.remove_front_zero();
+        return result;
+    }
+
+    // 每次读入一块: data = data * base^chunk_len + chunk
+    result.data.resize(len / radix.chunk_digits + 1);
+    std::size_t size = 0;
+    std::size_t chunk_len = (len % radix.chunk_digits != 0) ? len % radix.chunk_digits : radix.chunk_digits;
+    for (std::size_t pos = 0; pos < len; pos += chunk_len, chunk_len = radix.chunk_digits)
+    {
+        DataType carry = radix.read_chunk(digits + pos, digits + pos + chunk_len);
+        DataType scale = radix.chunk_base;
+        if (chunk_len != radix.chunk_digits)
+        {
+            scale = 1;
+            for (std::size_t i = 0; i < chunk_len; ++i)
+                scale *= radix.base;
+        }
+        for (std::size_t i = 0; i < size; ++i)
+            result.data[i] = mpn::mul_carry(result.data[i], scale, carry);
+        if (carry != 0)
+            result.data[size++] = carry;
+    }
+    result.remove_front_zero();
+    return result;
+}
+
+std::size_t BigInt::get_digits() const
+{
+    if (this->is_zero())
+        return 1;
+
+#if defined(BIGINT_BINARY_LIMBS)
+    // 2^(bits-1) <= |*this| < 2^bits, 两端的十进制位数相同时就是结果
+    const std::size_t bits = this->LIMB_BITS * (this->data.size() - 1) + std::bit_width(this->data.back());
+    const std::size_t digits = floor_log10_pow2(bits) + 1;
+    if (floor_log10_pow2(bits - 1) + 1 == digits)
+        return digits;
+
+    // 否则区间内恰有 10^(digits-1): 由缓存的 10^(19*2^k) 拼出它, 比较一次, 不做完整的转换
+    const Radix &radix = Radix::get(10);
+    std::size_t chunks = (digits - 1) / radix.chunk_digits;
+    DataType rest = 1;
+    for (std::size_t i = (digits - 1) % radix.chunk_digits; i != 0; --i)
+        rest *= 10;
+    BigInt power(false, {rest});
+    const std::vector<BigInt> &powers = radix.powers(std::bit_width(chunks));
+    for (std::size_t k = 0; chunks != 0; ++k, chunks >>= 1)
+    {
+        if (chunks & 1)
+            power = BigInt::mul(power, powers[k]);
+    }
+    return (BigInt::compare_abs(*this, power) < 0) ? digits - 1 : digits;
+#else
+    return std::log10(this->data.back()) + 1 + this->EXP * (this->data.size() - 1);
+#endif
+}
+
+// 按 radix 转换后位数的上界
+std::size_t BigInt::max_digits(const Radix &radix) const
+{
+    if (this->data.empty())
+        return 1;
+#if defined(BIGINT_BINARY_LIMBS)
+    const std::size_t bits = this->LIMB_BITS * (this->data.size() - 1) + std::bit_width(this->data.back());
+    if (radix.bits != 0)
+        return (bits + radix.bits - 1) / radix.bits;
+    return static_cast<std::size_t>(bits / std::log2(radix.base)) + 2;
+#else
+    if (!radix.raw && radix.base == 10)
+        return this->EXP * this->data.size();
+    // |*this| < 10^digits
+    return static_cast<std::size_t>(this->get_digits() * std::log(10.0) / std::log(radix.base)) + 2;
+#endif
+}
+
+// 按 radix 转换后位数的下界
+std::size_t BigInt::min_digits(const Radix &radix) const
+{
+    if (this->data.empty())
+        return 1;
+#if defined(BIGINT_BINARY_LIMBS)
+    // 2 的幂进制时 max_digits 是精确值, 否则最多多出两位
+    const std::size_t max = this->max_digits(radix);
+    if (radix.bits != 0)
+        return max;
+    return (max > 2) ? max - 2 : 1;
+#else
+    const std::size_t digits = this->get_digits();
+    if (!radix.raw && radix.base == 10)
+        return digits;
+    // |*this| >= 10^(digits - 1), 留出浮点误差
+    return static_cast<std::size_t>((digits - 1) * std::log(10.0) / std::log(radix.base) * (1 - 1e-12)) + 1;
+#endif
+}
+
+// 分治转换的层数: 最小的 level 使 |*this| < chunk_base^(2^level), 即 powers[level - 1] 的平方超过 *this
+std::size_t BigInt::radix_level(const Radix &radix) const
+{
+    std::size_t level = 0;
+    if (this->data.size() > STR_DIVIDE_LIMBS)
+    {
+        level = 1;
+        while (2 * radix.powers(level)[level - 1].data.size() - 1 <= this->data.size())
+            ++level;
+    }
+    return level;
+}
+
+// 写入 |*this| 在 radix 下的表示, 返回写入的终点
+char *BigInt::write_digits(char *out, const Radix &radix) const
+{
+    BIGINT_STATS_SCOPE(format, this->data.size());
+    if (this->data.empty())
+    {
+        *out = radix.digit(0);
+        return out + 1;
+    }
+
+#if defined(BIGINT_BINARY_LIMBS)
+    if (radix.bits != 0)
+        return this->write_bits(out, radix, this->max_digits(radix), 0);
+#else
+    if (!radix.raw && radix.base == 10)
+        return radix.write_chunks(out, this->data.data(), this->data.size(), 0);
+#endif
+
+    const std::size_t level = this->radix_level(radix);
+    return BigInt::write_digits(out, *this, radix, radix.powers(level), level, false);
+}
+
+#if defined(BIGINT_BINARY_LIMBS)
+// 2 的幂进制直接按比特切分, 从高到低写入第 high - 1 到第 low 位
+char *BigInt::write_bits(char *out, const Radix &radix, const std::size_t high, const std::size_t low) const
+{
+    const DataType mask = (static_cast<DataType>(1) << radix.bits) - 1;
+    for (std::size_t i = high; i-- > low;)
+    {
+        const std::size_t pos = i * radix.bits, limb = pos / this->LIMB_BITS, shift = pos % this->LIMB_BITS;
+        DataType value = this->data[limb] >> shift;
+        if (shift + radix.bits > this->LIMB_BITS && limb + 1 < this->data.size())
+            value |= this->data[limb + 1] << (this->LIMB_BITS - shift);
+        *out++ = radix.digit(static_cast<unsigned>(value & mask));
+    }
+    return out;
+}
+#endif
+
+// 要求 |num| < chunk_base^(2^level); padded 时补零到 chunk_digits * 2^level 位
+// 除以 powers[level - 1] 后分别转换商和余数, 子问题的除数都来自同一张幂表
+char *BigInt::write_digits(char *out, const BigInt &num, const Radix &radix, const std::vector<BigInt> &powers, const std::size_t level, const bool padded)
+{
+    const std::size_t width = padded ? radix.chunk_digits << level : 0;
+    if (level == 0 || num.data.size() <= STR_DIVIDE_LIMBS)
+    {
+        // 反复除以 chunk_base 得到各块, 低位在前; 每个 limb 至多产生两块
+        std::size_t size = num.data.size(), count = 0;
+        ScratchArena::Frame frame;
+        DataType *rest = frame.allocate(size);
+        DataType *chunks = frame.allocate(2 * size);
+        std::copy(num.data.begin(), num.data.end(), rest);
+        while (size != 0)
+        {
+            chunks[count++] = BigInt::div_limbs(rest, rest, size, radix.chunk_base);
+            if (rest[size - 1] == 0)
+                --size;
+        }
+        return radix.write_chunks(out, chunks, count, width);
+    }
+
+    const BigInt &power = powers[level - 1];
+    if (!padded && num.normal_smaller(power))
+        return BigInt::write_digits(out, num, radix, powers, level - 1, false);
+
+    BigInt quot, rem;
+    BigInt::normal_divmod(num, power, quot, rem);
+    out = BigInt::write_digits(out, quot, radix, powers, level - 1, padded);
+    return BigInt::write_digits(out, rem, radix, powers, level - 1, true);
+}
+
+void BigInt::emit_digits(const Radix &radix, const bool upper, const DigitSink sink, void *context) const
+{
+    std::array<char, STREAM_BLOCK> block;
+    if (this->max_digits(radix) <= STREAM_BLOCK)
+    {
+        emit_block(block.data(), this->write_digits(block.data(), radix), upper, sink, context);
+        return;
+    }
+
+    BIGINT_STATS_SCOPE(format, this->data.size());
+#if defined(BIGINT_BINARY_LIMBS)
+    if (radix.bits != 0)
+    {
+        for (std::size_t high = this->max_digits(radix); high != 0;)
+        {
+            const std::size_t low = (high > STREAM_BLOCK) ? high - STREAM_BLOCK : 0;
+            emit_block(block.data(), this->write_bits(block.data(), radix, high, low), upper, sink, context);
+            high = low;
+        }
+        return;
+    }
+#else
+    if (!radix.raw && radix.base == 10)
+    {
+        // 最高的 limb 不补零, 其余的 limb 每个写 EXP 位
+        emit_block(block.data(), radix.write_chunks(block.data(), &this->data.back(), 1, 0), upper, sink, context);
+        const std::size_t group = STREAM_BLOCK / this->EXP;
+        for (std::size_t high = this->data.size() - 1; high != 0;)
+        {
+            const std::size_t low = (high > group) ? high - group : 0;
+            emit_block(block.data(), radix.write_chunks(block.data(), this->data.data() + low, high - low, (high - low) * this->EXP), upper, sink, context);
+            high = low;
+        }
+        return;
+    }
+#endif
+
+    const std::size_t level = this->radix_level(radix);
+    BigInt::emit_digits(*this, radix, radix.powers(level), level, false, block.data(), upper, sink, context);
+}
+
+// 与 write_digits 的分治相同, 子问题的结果不超过 STREAM_BLOCK 位时写入 block 并输出
+void BigInt::emit_digits(const BigInt &num, const Radix &radix, const std::vector<BigInt> &powers, const std::size_t level, const bool padded, char *block, const bool upper, const DigitSink sink, void *context)
+{
+    if ((padded ? radix.chunk_digits << level : num.max_digits(radix)) <= STREAM_BLOCK)
+    {
+        emit_block(block, BigInt::write_digits(block, num, radix, powers, level, padded), upper, sink, context);
+        return;
+    }
+
+    const BigInt &power = powers[level - 1];
+    if (!padded && num.normal_smaller(power))
+    {
+        BigInt::emit_digits(num, radix, powers, level - 1, false, block, upper, sink, context);
+        return;
+    }
+
+    BigInt quot, rem;
+    BigInt::normal_divmod(num, power, quot, rem);
+    BigInt::emit_digits(quot, radix, powers, level - 1, padded, block, upper, sink, context);
+    BigInt::emit_digits(rem, radix, powers, level - 1, true, block, upper, sink, context);
+}
+
+void BigInt::format_to(const FormatSpec &spec, const DigitSink sink, void *context) const
+{
+    const Radix &radix = Radix::get(spec.base);
+
+    // 符号与前缀
+    std::string head;
+    if (this->negative)
+        head += '-';
+    else if (spec.sign != '-')
+        head += spec.sign;
+    // 八进制的前缀 "0" 本身就是一位 0, 值为 0 时只输出一个 "0", 与 printf / std::format 一致
+    if (spec.base != 8 || !this->is_zero())
+        head += spec.prefix;
+
+    // 位数一定不小于宽度时不需要补齐, 直接分块输出
+    if (spec.width <= head.size() + this->min_digits(radix))
+    {
+        sink(context, head.data(), head.size());
+        this->emit_digits(radix, spec.upper, sink, context);
+        return;
+    }
+
+    // 否则结果不会比 width 长多少, 先完整转换以得到精确的位数
+    std::string digits(this->max_digits(radix), '\0');
+    char *end = this->write_digits(digits.data(), radix);
+    if (spec.upper)
+        to_upper(digits.data(), end);
+    digits.resize(end - digits.data());
+
+    const std::size_t pad = (spec.width > head.size() + digits.size()) ? spec.width - head.size() - digits.size() : 0;
+    std::size_t before = pad;
+    if (spec.align == FormatSpec::Align::left)
+        before = 0;
+    else if (spec.align == FormatSpec::Align::center)
+        before = pad / 2;
+    const std::string fill_before(before, spec.fill), fill_after(pad - before, spec.fill);
+
+    if (spec.align == FormatSpec::Align::internal)
+    {
+        sink(context, head.data(), head.size());
+        sink(context, fill_before.data(), fill_before.size());
+    }
+    else
+    {
+        sink(context, fill_before.data(), fill_before.size());
+        sink(context, head.data(), head.size());
+    }
+    sink(context, digits.data(), digits.size());
+    sink(context, fill_after.data(), fill_after.size());
+}
+
 std::istream &operator>>(std::istream &is, BigInt &num)
 {
-    std::string str;
-    std::cin >> str;
-    num = BigInt(str);
+    const std::istream::sentry sentry(is);
+    if (!sentry)
+        return is;
+
+    const std::ios_base::fmtflags base_flags = is.flags() & std::ios_base::basefield;
+    const int base = (base_flags == std::ios_base::hex) ? 16 : (base_flags == std::ios_base::oct) ? 8 : 10;
+    const BigInt::Radix &radix = BigInt::Radix::get(base);
+
+    // 直接从 streambuf 逐个读取合法的字符, 停在第一个不属于该数的字符上
+    // streambuf 不保证字符连续存放, 所以先把数字收集到 digits 再交给 from_chars 一次转换, 这次复制是有意的
+    std::streambuf *buf = is.rdbuf();
+    std::ios_base::iostate state = std::ios_base::goodbit;
+    std::string digits;
+    bool negative = false;
+    bool prefixed = false;
+    int c = buf->sgetc();
+    if (c == '-' || c == '+')
+    {
+        negative = c == '-';
+        c = buf->snextc();
+    }
+    // 十六进制允许 0x 前缀; 与 num_get 相同, 前缀后没有数字 (如 "0xg") 时读取失败, 结果为 0, 前缀已被消耗
+    if (base == 16 && c == '0')
+    {
+        digits += '0';
+        c = buf->snextc();
+        if (c == 'x' || c == 'X')
+        {
+            prefixed = true;
+            c = buf->snextc();
+        }
+    }
+    for (; c != std::char_traits<char>::eof() && radix.value(static_cast<char>(c)) < radix.base; c = buf->snextc())
+        digits += static_cast<char>(c);
+    if (c == std::char_traits<char>::eof())
+        state |= std::ios_base::eofbit;
 
+    if (digits.empty() || (prefixed && digits.size() == 1))
+    {
+        num = BigInt();
+        state |= std::ios_base::failbit;
+    }
+    else
+    {
+        BigInt::from_chars(digits.data(), digits.data() + digits.size(), num, base);
+        num.negative = negative && !num.data.empty();
+    }
+    is.setstate(state);
     return is;
 }
 
 std::ostream &operator<<(std::ostream &os, const BigInt &num)
 {
-    os << num.to_str();
+    const std::ostream::sentry sentry(os);
+    if (!sentry)
+        return os;
+
+    const std::ios_base::fmtflags flags = os.flags();
+    BigInt::FormatSpec spec;
+    if ((flags & std::ios_base::basefield) == std::ios_base::hex)
+        spec.base = 16;
+    else if ((flags & std::ios_base::basefield) == std::ios_base::oct)
+        spec.base = 8;
+    spec.upper = (flags & std::ios_base::uppercase) != 0;
+    if (flags & std::ios_base::showpos)
+        spec.sign = '+';
+    // 与内置整数相同, 0 不加前缀
+    if ((flags & std::ios_base::showbase) && !num.is_zero())
+        spec.prefix = (spec.base == 16) ? (spec.upper ? "0X" : "0x") : (spec.base == 8) ? "0" : "";
+    spec.fill = os.fill();
+    if ((flags & std::ios_base::adjustfield) == std::ios_base::left)
+        spec.align = BigInt::FormatSpec::Align::left;
+    else if ((flags & std::ios_base::adjustfield) == std::ios_base::internal)
+        spec.align = BigInt::FormatSpec::Align::internal;
+    spec.width = (os.width() > 0) ? static_cast<std::size_t>(os.width()) : 0;
+    os.width(0);
+
+    struct Target
+    {
+        std::streambuf *buf;
+        bool failed;
+    } target{os.rdbuf(), false};
+    num.format_to(
+        spec, [](void *context, const char *data, const std::size_t len)
+        {
+            Target &target = *static_cast<Target *>(context);
+            if (!target.failed && target.buf->sputn(data, len) != static_cast<std::streamsize>(len))
+                target.failed = true;
+        },
+        &target);
+    if (target.failed)
+        os.setstate(std::ios_base::badbit);
     return os;
 }
@@ -4,13 +4,90 @@
 #include <vector>
 #include <cstdint>
 #include <iomanip>
+#if __has_include(<format>)
 #include <format>
+#endif
 #include <cmath>
 #include <numeric>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <memory>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include "SmallVector.h"
+#include "Mpn.h"
+#include "BigIntStats.h"
+
+// 内联保存的 limb 数, 不超过该长度的数不分配堆内存
+#ifndef BIGINT_INLINE_LIMBS
+#define BIGINT_INLINE_LIMBS 8
+#endif
+
+// limb 的堆内存与乘除法临时空间都通过该分配器模板分配, 可定义为自定义内存池的分配器
+// 例如 -DBIGINT_LIMB_ALLOCATOR=std::pmr::polymorphic_allocator
+#ifndef BIGINT_LIMB_ALLOCATOR
+#define BIGINT_LIMB_ALLOCATOR std::allocator
+#endif
+class ModContext;
+class MappedBigInt;
+class BigIntView;
+class Executor;
+namespace bigexpr
+{
+    class Kernel;
+}
+
 class BigInt
 {
+    friend class ModContext;
+    friend class MappedBigInt;
+    friend class BigIntView;
+    friend class bigexpr::Kernel;
+
 public:
-    using DataType = std::uint_fast32_t;
+    // 定义 BIGINT_BINARY_LIMBS 时使用 2^64 进制的二进制 limb，否则使用 10^9 进制
+    using DataType = mpn::Limb;
+#if defined(BIGINT_STATS)
+    using LimbAllocator = bigint_stats::CountingAllocator<BIGINT_LIMB_ALLOCATOR<DataType>>;
+#else
+    using LimbAllocator = BIGINT_LIMB_ALLOCATOR<DataType>;
+#endif
+
+    // 各算法切换的 limb 数阈值
+    struct Thresholds
+    {
+        std::size_t karatsuba = 24;
+        std::size_t toom3 = 300;
+#if defined(BIGINT_BINARY_LIMBS)
+        std::size_t ntt = 900;
+        std::size_t burnikel_ziegler = 120;
+        std::size_t hgcd = 150;
+#else
+        std::size_t ntt = 1600;
+        std::size_t burnikel_ziegler = 80;
+        std::size_t hgcd = 300;
+#endif
+    };
+
+    // 乘法的并行方式, executor 为空时顺序计算 (默认)
+    // 较短的操作数不少于 min_limbs 个 limb 时, Karatsuba / Toom-3 的子乘积与 NTT 的各个变换作为任务交给 executor,
+    // 任务中的乘法可以继续拆分, 最多嵌套 max_depth 层
+    struct Parallelism
+    {
+        Executor *executor = nullptr;
+        std::size_t min_limbs = 1024;
+        std::size_t max_depth = 4;
+    };
 
     BigInt();
     BigInt(bool negative, const std::vector<DataType> &data);
@@ -21,6 +98,7 @@ public:
     BigInt(const std::string &s);
     BigInt(const BigInt &other);
     BigInt(BigInt &&other);
+    explicit BigInt(BigIntView view);
 
     bool normal_equal(const BigInt &num) const;
     bool normal_larger(const BigInt &num) const;
@@ -35,6 +113,9 @@ public:
 
     bool is_zero() const;
     std::size_t get_digits() const;
+    std::size_t get_limbs() const;
+    // 返回 -1, 0, 1 表示 a 小于, 等于, 大于 b
+    static int compare(BigIntView a, BigIntView b);
 
     BigInt operator++(int);
     BigInt operator--(int);
@@ -43,18 +124,38 @@ public:
     BigInt &operator=(BigInt &&other);
     BigInt operator+(const BigInt &num) const;
     BigInt &operator+=(const BigInt &num);
+    BigInt &operator+=(BigIntView num);
     BigInt operator-() const;
     BigInt operator-(const BigInt &num) const;
     BigInt &operator-=(const BigInt &num);
+    BigInt &operator-=(BigIntView num);
     BigInt operator*(const BigInt &num) const;
     BigInt &operator*=(const BigInt &num);
+    BigInt &operator*=(BigIntView num);
+    BigInt square() const;
     BigInt operator/(const BigInt &num) const;
     BigInt &operator/=(const BigInt &num);
+    BigInt &operator/=(BigIntView num);
     BigInt operator%(const BigInt &num) const;
     BigInt &operator%=(const BigInt &num);
+    BigInt &operator%=(BigIntView num);
+    std::pair<BigInt, BigInt> divmod(const BigInt &num) const;
     BigInt operator^(const BigInt &num) const;
     BigInt &operator^=(const BigInt &num);
     BigInt inverse() const;
+    // constant_time 时使用 ModContext::pow_ladder, 要求模数与 limb 进制互素, 只有指数受保护
+    static BigInt pow_mod(const BigInt &base, const BigInt &exp, const BigInt &mod, const bool constant_time = false);
+
+    // 任一操作数为 BigIntView 时使用, 结果与 BigInt 之间的运算相同
+    friend BigInt operator+(BigIntView a, BigIntView b);
+    friend BigInt operator-(BigIntView a, BigIntView b);
+    friend BigInt operator*(BigIntView a, BigIntView b);
+    friend BigInt operator/(BigIntView a, BigIntView b);
+    friend BigInt operator%(BigIntView a, BigIntView b);
+
+    friend BigInt gcd(const BigInt &a, const BigInt &b);
+    friend std::tuple<BigInt, BigInt, BigInt> ext_gcd(const BigInt &a, const BigInt &b);
+    friend BigInt mod_inverse(const BigInt &a, const BigInt &mod);
 
     BigInt operator*(const std::uint32_t num) const;
     friend BigInt operator*(const std::uint32_t num, const BigInt &bigint);
@@ -62,34 +163,455 @@ public:
     friend BigInt operator/(const uint32_t num, const BigInt &bigint);
     BigInt operator/=(const uint32_t num);
 
-    static BigInt from_str(const std::string &s);
-    std::string to_str() const;
+    // base 取 2 ~ 36, 大于 9 的数字用小写字母表示, 解析时不区分大小写
+    static BigInt from_str(const std::string &s, const int base = 10);
+    std::string to_str(const int base = 10) const;
+    // 与 std::from_chars / std::to_chars 相同的约定, 不经过 std::string
+    static std::from_chars_result from_chars(const char *first, const char *last, BigInt &value, const int base = 10);
+    std::to_chars_result to_chars(char *first, char *last, const int base = 10) const;
 
+    // 绝对值的字节表示, 不含符号, 0 没有字节; 十进制 limb 下需要先做进制转换
+    std::size_t byte_size() const;
+    // 写入 out 的前 byte_size() 个字节并返回字节数, 空间不足时抛出异常
+    std::size_t to_bytes(std::span<std::byte> out, const std::endian order = std::endian::big) const;
+    std::vector<std::byte> to_bytes(const std::endian order = std::endian::big) const;
+    static BigInt from_bytes(std::span<const std::byte> bytes, const std::endian order = std::endian::big);
+
+    // 线格式: LEB128 编码的 (字节数 << 1 | 符号), 后接小端序的绝对值字节
+    std::size_t wire_size() const;
+    std::size_t to_wire(std::span<std::byte> out) const;
+    std::vector<std::byte> to_wire() const;
+    // 返回读取的字节数, 数据不完整时抛出异常
+    static std::size_t from_wire(std::span<const std::byte> in, BigInt &value);
+
+    // 按流的 basefield (hex / oct / dec) 读写, 输出支持 width / fill / adjustfield / showbase / showpos / uppercase
     friend std::istream &operator>>(std::istream &is, BigInt &num);
     friend std::ostream &operator<<(std::ostream &os, const BigInt &num);
 
+    // 格式说明, 对应 std::format 的 [[fill]align][sign][#][0][width][type]
+    struct FormatSpec
+    {
+        enum class Align
+        {
+            left,
+            right,
+            center,
+            internal
+        };
+
+        int base = 10;
+        bool upper = false;
+        // '-' 只给负数加符号, '+' 和 ' ' 给非负数加上 '+' 或空格
+        char sign = '-';
+        // 写在符号之后的进制前缀, 例如 "0x"
+        const char *prefix = "";
+        char fill = ' ';
+        Align align = Align::right;
+        std::size_t width = 0;
+    };
+    // 按块接收输出的字符
+    using DigitSink = void (*)(void *context, const char *data, std::size_t len);
+
+    // 解析到 '}' 或 last 为止, 返回停止的位置; 格式不合法时抛出 Error
+    template <typename Error = std::runtime_error, typename It>
+    static constexpr It parse_format_spec(It first, It last, FormatSpec &spec);
+    // 依次把各块交给 sink, 除需要补齐宽度的情况外不构造完整的字符串
+    void format_to(const FormatSpec &spec, DigitSink sink, void *context) const;
+
+    // 只保存指针: 之后修改 *mod_tar 时, 下一次运算会按新的模数重新建立上下文; *mod_tar 需要在解除注入前保持有效
+    // 只想在一段代码内使用某个模数时, 优先使用 ModScope
     static void inject_mod(BigInt *mod_tar);
+    class ModScope;
+    // 阈值与并行方式是不加锁的全局设置, 工作线程也会读取; 只能在没有其他线程使用 BigInt 时修改 (通常在程序启动时)
+    static void set_thresholds(const Thresholds &thresholds);
+    static const Thresholds &get_thresholds();
+    static void set_parallelism(const Parallelism &parallelism);
+    static const Parallelism &get_parallelism();
 
 private:
-    BigInt normal_add(const BigInt &num, const bool negative) const;
-    BigInt &self_normal_add(const BigInt &num, const bool negative);
+    using LimbVector = SmallVector<DataType, BIGINT_INLINE_LIMBS, LimbAllocator>;
+
+    BigInt(bool negative, LimbVector &&data);
+
+    static int compare_abs(BigIntView a, BigIntView b);
+    static BigInt add(BigIntView a, BigIntView b);
+
+    static BigInt normal_add(BigIntView a, BigIntView b, const bool negative);
+    BigInt &self_normal_add(BigIntView num, const bool negative);
+
+    static BigInt normal_substract(BigIntView a, BigIntView b, const bool negative);
+    BigInt &self_normal_substract(BigIntView num, const bool negative);
+    BigInt &self_reverse_substract(BigIntView num, const bool negative);
 
-    BigInt normal_substract(const BigInt &num, const bool negative) const;
-    BigInt &self_normal_substract(const BigInt &num, const bool negative);
+    static BigInt mul(BigIntView a, BigIntView b);
+    static void mul_dispatch(DataType *result, const DataType *a, std::size_t a_len, const DataType *b, std::size_t b_len);
+    static void mul_basecase(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len);
+    static void sqr_basecase(DataType *result, const DataType *a, const std::size_t len);
+    static void mul_karatsuba(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len);
+    static void mul_toom3(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len);
+    static void mul_ntt(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len);
+    static bool ntt_fits(const std::size_t a_len, const std::size_t b_len);
+
+    // quot 与 rem 不能与 a, b 指向同一段内存
+    static void normal_divmod(BigIntView a, BigIntView b, BigInt &quot, BigInt &rem);
+    static void knuth_divmod(BigIntView a, BigIntView b, BigInt &quot, BigInt &rem);
+    static void recursive_divmod(BigIntView a, BigIntView b, BigInt &quot, BigInt &rem);
+    static void div_2n_1n(BigIntView a, BigIntView b, std::size_t n, BigInt &quot, BigInt &rem);
+    static void div_3n_2n(BigIntView a12, BigIntView a3, BigIntView b, BigIntView b1, BigIntView b2, const std::size_t n, BigInt &quot, BigInt &rem);
+
+    // 2x2 矩阵 {m00, m01, m10, m11}, 作用于 (a, b) 的列向量
+    using GcdMatrix = std::array<BigInt, 4>;
+
+    static BigInt from_int64(const std::int64_t num);
+    static bool lehmer_matrix(const BigInt &a, const BigInt &b, GcdMatrix &matrix);
+    static void apply_matrix(const GcdMatrix &matrix, BigInt &x, BigInt &y);
+    static void apply_matrix(const GcdMatrix &matrix, GcdMatrix &target);
+    static void gcd_normalize(BigInt &a, BigInt &b, GcdMatrix *track);
+    static void gcd_step(BigInt &a, BigInt &b, GcdMatrix *track);
+    static GcdMatrix hgcd(BigIntView a, BigIntView b);
+    static BigInt gcd_reduce(BigInt a, BigInt b, GcdMatrix *track);
+
+private:
+    // 指针形式的 limb 运算, 由 mpn 实现
+    static DataType add_limbs(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len);
+    static DataType sub_limbs(DataType *result, const DataType *a, const std::size_t a_len, const DataType *b, const std::size_t b_len);
+    static DataType mul_limbs(DataType *result, const DataType *a, const std::size_t len, const DataType num);
+    static DataType addmul_limbs(DataType *result, const DataType *a, const std::size_t len, const DataType num);
+    static DataType div_limbs(DataType *result, const DataType *a, const std::size_t len, const DataType num);
 
 private:
+    // 临时关闭模数约化, 用于内部的中间计算
+    // 连同 inject_mod 建立的上下文的所有权一起保存, 期间再次 inject_mod 也不会释放恢复时要用的上下文
+    class ModSuspend
+    {
+    public:
+        ModSuspend();
+        ~ModSuspend();
+
+        ModSuspend(const ModSuspend &) = delete;
+        ModSuspend &operator=(const ModSuspend &) = delete;
+
+    private:
+        BigInt *saved;
+        const ModContext *saved_ctx;
+        std::unique_ptr<ModContext> saved_owner;
+    };
+
+    void mod_reduce();
+    // 当前线程绑定的模数对应的上下文, 没有绑定时返回 nullptr
+    static const ModContext *mod_context();
+
     void chunk_move_left(const std::size_t sz);
     void chunk_move_right(const std::size_t sz);
-    void digit_move_left(const std::size_t sz);
-    void digit_move_right(const std::size_t sz);
 
+    // 各进制的转换常量, 定义在 BigInt.cpp; digits 只含该进制的有效数字, 高位在前
+    struct Radix;
+    static BigInt parse_digits(const char *digits, const std::size_t len, const Radix &radix);
+    std::size_t max_digits(const Radix &radix) const;
+    char *write_digits(char *out, const Radix &radix) const;
+    static char *write_digits(char *out, const BigInt &num, const Radix &radix, const std::vector<BigInt> &powers, const std::size_t level, const bool padded);
+    std::size_t min_digits(const Radix &radix) const;
+    std::size_t radix_level(const Radix &radix) const;
+#if defined(BIGINT_BINARY_LIMBS)
+    char *write_bits(char *out, const Radix &radix, const std::size_t high, const std::size_t low) const;
+#endif
+    // 分块输出, block 为调用方提供的缓冲区
+    void emit_digits(const Radix &radix, const bool upper, DigitSink sink, void *context) const;
+    static void emit_digits(const BigInt &num, const Radix &radix, const std::vector<BigInt> &powers, const std::size_t level, const bool padded, char *block, const bool upper, DigitSink sink, void *context);
+
+    std::vector<std::uint32_t> binary_words() const;
     void remove_front_zero();
 
 private:
+#if defined(BIGINT_BINARY_LIMBS)
+    using WideType = mpn::WideLimb;
+    static const std::uint8_t LIMB_BITS = mpn::LIMB_BITS;
+    // 十进制转换时每块的位数, 10^19 < 2^64
+    static const std::uint8_t EXP = 19;
+    static const std::uint64_t STR_LIMIT = 10000000000000000000ull;
+#else
+    using WideType = mpn::WideLimb;
     static const std::uint8_t EXP = 9;
-    static const std::uint_fast32_t LIMIT = 1000000000;
-    static BigInt *__mod_tar;
+    static const std::uint_fast32_t LIMIT = mpn::LIMIT;
+#endif
+    // 模数按线程绑定, 不同线程可以使用不同的模数
+    static thread_local BigInt *__mod_tar;
+    static thread_local const ModContext *__mod_ctx;
+    static Thresholds thresholds;
+    static Parallelism parallelism;
     bool negative = false;
-    std::vector<DataType> data;
+    LimbVector data;
+};
+
+// 不持有内存的只读操作数: 符号与低位在前的 limb
+// 可以指向 BigInt, BigInt 的一段 limb, 映射的文件或外部缓冲区, 被指向的内存需要在使用期间保持有效
+// 切片只调整指针与长度, 不复制 limb
+class BigIntView
+{
+public:
+    using DataType = BigInt::DataType;
+
+    constexpr BigIntView() = default;
+    BigIntView(const BigInt &num) : negative(num.negative), data(num.data.data(), num.data.size()) {}
+    // 忽略高位的 0; 十进制 limb 下每个 limb 都要小于 LIMIT
+    constexpr BigIntView(const bool negative, std::span<const DataType> limbs) : data(limbs.first(mpn::normalized_size(limbs))) { this->negative = negative && !this->data.empty(); }
+
+    constexpr bool is_negative() const { return this->negative; }
+    constexpr bool is_zero() const { return this->data.empty(); }
+    constexpr std::size_t size() const { return this->data.size(); }
+    constexpr std::span<const DataType> limbs() const { return this->data; }
+
+    constexpr BigIntView abs() const { return BigIntView(false, this->data); }
+    constexpr BigIntView operator-() const { return BigIntView(!this->negative, this->data); }
+    // 第 begin 到 end 个 limb 组成的非负数, 越界的部分视为 0
+    constexpr BigIntView slice(const std::size_t begin, const std::size_t end) const
+    {
+        const std::size_t last = std::min(end, this->data.size());
+        return (begin >= last) ? BigIntView() : BigIntView(false, this->data.subspan(begin, last - begin));
+    }
+    // |*this| = high(n) * LIMIT^n + low(n)
+    constexpr BigIntView low(const std::size_t n) const { return this->slice(0, n); }
+    constexpr BigIntView high(const std::size_t n) const { return this->slice(n, this->data.size()); }
+
+private:
+    bool negative = false;
+    std::span<const DataType> data;
+};
+
+inline bool operator==(BigIntView a, BigIntView b) { return BigInt::compare(a, b) == 0; }
+inline bool operator!=(BigIntView a, BigIntView b) { return BigInt::compare(a, b) != 0; }
+inline bool operator<(BigIntView a, BigIntView b) { return BigInt::compare(a, b) < 0; }
+inline bool operator>(BigIntView a, BigIntView b) { return BigInt::compare(a, b) > 0; }
+inline bool operator<=(BigIntView a, BigIntView b) { return BigInt::compare(a, b) <= 0; }
+inline bool operator>=(BigIntView a, BigIntView b) { return BigInt::compare(a, b) >= 0; }
+
+BigInt operator+(BigIntView a, BigIntView b);
+BigInt operator-(BigIntView a, BigIntView b);
+BigInt operator*(BigIntView a, BigIntView b);
+BigInt operator/(BigIntView a, BigIntView b);
+BigInt operator%(BigIntView a, BigIntView b);
+
+// 编译期的整数字面量: using namespace bigint_literals 后可以写 1000000007_big, 0xffff'ffff_big, -0b1011_big
+// limb 在编译期算出并放在只读数据中, 字面量的值是指向它们的 BigIntView, 不需要运行时的解析与分配
+namespace bigint_literals
+{
+    // limbs 的前 size 个有效; 出现不属于该进制的字符时 valid 为 false
+    template <std::size_t N>
+    struct ParsedLiteral
+    {
+        std::array<BigInt::DataType, N> limbs{};
+        std::size_t size = 0;
+        bool valid = true;
+    };
+
+    // 按 C++ 整数字面量的写法解析 text: 0x / 0b / 0 前缀分别表示十六, 二, 八进制, 忽略 ' 分隔符
+    // N 为 limb 数的上界, 取 text 的长度即可
+    template <std::size_t N>
+    constexpr ParsedLiteral<N> parse_literal(const std::string_view text)
+    {
+        using DataType = BigInt::DataType;
+#if defined(BIGINT_BINARY_LIMBS)
+        constexpr DataType chunk_limit = ~static_cast<DataType>(0);
+#else
+        constexpr DataType chunk_limit = mpn::LIMIT;
+#endif
+        ParsedLiteral<N> result;
+        std::size_t pos = 0;
+        DataType base = 10;
+        if (text.size() > 1 && text[0] == '0')
+        {
+            if (text[1] == 'x' || text[1] == 'X')
+                base = 16, pos = 2;
+            else if (text[1] == 'b' || text[1] == 'B')
+                base = 2, pos = 2;
+            else
+                base = 8, pos = 1;
+        }
+
+        // 把若干位数字合成一块, 再整体乘入已有的 limb: limbs = limbs * scale + chunk
+        const auto flush = [&](const DataType scale, const DataType chunk)
+        {
+            DataType carry = chunk;
+            for (std::size_t i = 0; i < result.size; ++i)
+                result.limbs[i] = mpn::mul_carry(result.limbs[i], scale, carry);
+            if (carry != 0)
+                result.limbs[result.size++] = carry;
+        };
+        DataType scale = 1, chunk = 0;
+        for (; pos < text.size(); ++pos)
+        {
+            const char c = text[pos];
+            if (c == '\'')
+                continue;
+            DataType digit = base;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            if (digit >= base)
+            {
+                result.valid = false;
+                return result;
+            }
+            if (scale > chunk_limit / base)
+            {
+                flush(scale, chunk);
+                scale = 1, chunk = 0;
+            }
+            scale *= base;
+            chunk = chunk * base + digit;
+        }
+        flush(scale, chunk);
+        return result;
+    }
+
+    template <char... Chars>
+    inline constexpr std::array<char, sizeof...(Chars)> literal_text{Chars...};
+    template <char... Chars>
+    inline constexpr ParsedLiteral<sizeof...(Chars)> parsed_literal = parse_literal<sizeof...(Chars)>(std::string_view(literal_text<Chars...>.data(), sizeof...(Chars)));
+
+    // 只保留有效的 limb
+    template <char... Chars>
+    inline constexpr auto literal_limbs = []
+    {
+        std::array<BigInt::DataType, parsed_literal<Chars...>.size> limbs{};
+        for (std::size_t i = 0; i < limbs.size(); ++i)
+            limbs[i] = parsed_literal<Chars...>.limbs[i];
+        return limbs;
+    }();
+
+    template <char... Chars>
+    constexpr BigIntView operator""_big()
+    {
+        static_assert(parsed_literal<Chars...>.valid, "invalid digit in BigInt literal");
+        return BigIntView(false, literal_limbs<Chars...>);
+    }
+}
+
+BigInt gcd(const BigInt &a, const BigInt &b);
+// 返回 (g, x, y), 满足 a * x + b * y = g = gcd(a, b)
+std::tuple<BigInt, BigInt, BigInt> ext_gcd(const BigInt &a, const BigInt &b);
+// 返回 [0, mod) 中 a 的逆元, 不可逆时抛出异常
+BigInt mod_inverse(const BigInt &a, const BigInt &mod);
+std::vector<BigInt> batch_mod_inverse(const std::vector<BigInt> &values, const BigInt &mod);
+
+template <typename Error, typename It>
+constexpr It BigInt::parse_format_spec(It first, It last, FormatSpec &spec)
+{
+    const auto align = [](const char c, FormatSpec::Align &result)
+    {
+        if (c == '<')
+            result = FormatSpec::Align::left;
+        else if (c == '>')
+            result = FormatSpec::Align::right;
+        else if (c == '^')
+            result = FormatSpec::Align::center;
+        else
+            return false;
+        return true;
+    };
+
+    bool aligned = false;
+    if (first != last && first + 1 != last && *first != '{' && *first != '}' && align(first[1], spec.align))
+    {
+        spec.fill = *first;
+        first += 2;
+        aligned = true;
+    }
+    else if (first != last && align(*first, spec.align))
+    {
+        ++first;
+        aligned = true;
+    }
+    if (first != last && (*first == '+' || *first == '-' || *first == ' '))
+        spec.sign = *first++;
+    const bool alternate = first != last && *first == '#';
+    if (alternate)
+        ++first;
+    // 没有指定对齐时, '0' 表示在符号与前缀之后补零
+    if (first != last && *first == '0')
+    {
+        if (!aligned)
+        {
+            spec.fill = '0';
+            spec.align = FormatSpec::Align::internal;
+        }
+        ++first;
+    }
+    for (; first != last && *first >= '0' && *first <= '9'; ++first)
+        spec.width = spec.width * 10 + (*first - '0');
+
+    if (first != last && *first != '}')
+    {
+        const char type = *first++;
+        spec.upper = type == 'B' || type == 'X';
+        if (type == 'b' || type == 'B')
+            spec.base = 2;
+        else if (type == 'o')
+            spec.base = 8;
+        else if (type == 'x' || type == 'X')
+            spec.base = 16;
+        else if (type != 'd')
+            throw Error("invalid format specifier for BigInt");
+    }
+    if (first != last && *first != '}')
+        throw Error("invalid format specifier for BigInt");
+
+    if (alternate)
+    {
+        if (spec.base == 2)
+            spec.prefix = spec.upper ? "0B" : "0b";
+        else if (spec.base == 8)
+            spec.prefix = "0";
+        else if (spec.base == 16)
+            spec.prefix = spec.upper ? "0X" : "0x";
+    }
+    return first;
+}
+
+#if defined(__cpp_lib_format)
+// 直接写入输出迭代器, 支持与整数相同的 fill / align / sign / # / 0 / width 与 b B o d x X
+template <>
+struct std::formatter<BigInt>
+{
+    constexpr auto parse(std::format_parse_context &ctx) { return BigInt::parse_format_spec<std::format_error>(ctx.begin(), ctx.end(), this->spec); }
+
+    template <typename FormatContext>
+    auto format(const BigInt &num, FormatContext &ctx) const
+    {
+        using Iterator = typename FormatContext::iterator;
+        Iterator out = ctx.out();
+        num.format_to(
+            this->spec, [](void *context, const char *data, const std::size_t len)
+            {
+                Iterator &it = *static_cast<Iterator *>(context);
+                it = std::copy(data, data + len, it);
+            },
+            &out);
+        return out;
+    }
+
+    BigInt::FormatSpec spec;
+};
+#endif
+
+// 在当前线程内绑定模数, 析构时恢复之前的绑定, 包括之前 inject_mod 的模数; 作用域内的 inject_mod 在析构时失效
+class BigInt::ModScope
+{
+public:
+    explicit ModScope(const BigInt &mod);
+    ~ModScope();
+
+    ModScope(const ModScope &) = delete;
+    ModScope &operator=(const ModScope &) = delete;
+
+private:
+    BigInt mod;
+    std::unique_ptr<ModContext> context;
+    BigInt *saved;
+    const ModContext *saved_ctx;
+    std::unique_ptr<ModContext> saved_owner;
 };
 #endif
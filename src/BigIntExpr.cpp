@@ -0,0 +1,105 @@
+#include "BigIntExpr.h"
+#include "ScratchArena.h"
+#include <algorithm>
+
+namespace bigexpr
+{
+    BigInt Kernel::sum(std::span<const Term> terms)
+    {
+        using DataType = BigInt::DataType;
+
+        // 第一个乘积项 (没有时取第一个非零项) 直接写入结果作为基数, 其余乘积项写入临时空间
+        const Term *base = nullptr;
+        std::size_t len = 0, scratch = 0;
+        for (const Term &term : terms)
+        {
+            const std::size_t size = term.a->data.size() + ((term.b != nullptr) ? term.b->data.size() : 0);
+            if (term.a->data.empty() || (term.b != nullptr && term.b->data.empty()))
+                continue;
+            len = std::max(len, size);
+            if (term.b != nullptr)
+                scratch += 4 * size + 64 + ((base != nullptr && base->b != nullptr) ? size : 0);
+            if (base == nullptr || (base->b == nullptr && term.b != nullptr))
+                base = &term;
+        }
+        if (base == nullptr)
+            return BigInt();
+        ScratchArena::Frame frame(scratch);
+
+        BigInt result;
+        result.data.resize(len + 1);
+        DataType *out = result.data.data();
+        const BigInt &base_a = *base->a;
+        bool negative = base_a.negative != base->negate;
+        if (base->b == nullptr)
+            std::copy(base_a.data.begin(), base_a.data.end(), out);
+        else
+        {
+            const BigInt &base_b = *base->b;
+            BigInt::mul_dispatch(out, base_a.data.data(), base_a.data.size(), base_b.data.data(), base_b.data.size());
+            negative = negative != base_b.negative;
+        }
+
+        // 其余各项依次原地加减, 结果按 len + 1 个 limb 的补码保存 (基数为负时对所有项取反)
+        // 项数远小于进制, 和的绝对值小于最高 limb 进制的一半, 可以由最高 limb 判断符号
+        const std::span<DataType> acc(out, len + 1);
+        for (const Term &term : terms)
+        {
+            const BigInt &a = *term.a;
+            if (&term == base || a.data.empty())
+                continue;
+
+            std::span<const DataType> addend(a.data.data(), a.data.size());
+            bool sign = a.negative != term.negate;
+            if (term.b != nullptr)
+            {
+                const BigInt &b = *term.b;
+                if (b.data.empty())
+                    continue;
+                const std::size_t size = a.data.size() + b.data.size();
+                DataType *product = frame.allocate(size);
+                BigInt::mul_dispatch(product, a.data.data(), a.data.size(), b.data.data(), b.data.size());
+                addend = std::span<const DataType>(product, mpn::normalized_size({product, size}));
+                sign = sign != b.negative;
+            }
+
+            if (sign == negative)
+                mpn::add(acc, acc, addend);
+            else
+                mpn::sub(acc, acc, addend);
+        }
+
+#if defined(BIGINT_BINARY_LIMBS)
+        const bool complement = (out[len] >> (mpn::LIMB_BITS - 1)) != 0;
+#else
+        const bool complement = out[len] >= mpn::LIMIT / 2;
+#endif
+        if (complement)
+            mpn::neg(acc, acc);
+        result.negative = negative != complement;
+        result.remove_front_zero();
+
+        result.mod_reduce();
+
+        return result;
+    }
+
+    BigInt Kernel::mul_mod(const BigInt &a, const BigInt &b, const BigInt &mod)
+    {
+        if (mod.is_zero())
+            throw std::runtime_error("mod by zero");
+
+        BigInt product(BigInt::mul(a, b));
+        if (const ModContext *context = BigInt::mod_context(); context != nullptr)
+        {
+            // 与注入的模数相同时约化一次即可
+            product = context->reduce(product);
+            if (mod.normal_equal(*BigInt::__mod_tar))
+                return product;
+        }
+
+        return product % mod;
+    }
+
+    BigInt Kernel::mul_mod(const BigInt &a, const BigInt &b, const ModContext &context) { return context.reduce(BigInt::mul(a, b)); }
+}
@@ -0,0 +1,212 @@
+#ifndef BIGINTEXPRCPP
+#define BIGINTEXPRCPP
+#include "BigInt.h"
+#include "ModContext.h"
+#include <span>
+#include <concepts>
+#include <type_traits>
+
+// 惰性求值的表达式模板, 通过 lazy() 显式开启:
+//   BigInt r = lazy(a) + b - c * d;
+// 整条加减链在同一个结果缓冲区上原地累加, 只分配一次结果; 第一个乘积直接写入结果 (a * b + c 不产生中间 BigInt),
+// (lazy(a) * b) % m 直接交给乘法取模的内核
+// 表达式只保存操作数的引用, 需要在同一个完整表达式内求值, 不要用 auto 保存
+namespace bigexpr
+{
+    // 求和中的一项: b 为空时表示 a, 否则表示 a * b; negate 表示减去该项
+    struct Term
+    {
+        const BigInt *a;
+        const BigInt *b;
+        bool negate;
+    };
+
+    class Kernel
+    {
+    public:
+        // 带符号的多项求和, 注入模数时对结果约化一次
+        static BigInt sum(std::span<const Term> terms);
+        // 与 a * b % mod 的结果相同, 但乘积不经过中间的约化与复制
+        static BigInt mul_mod(const BigInt &a, const BigInt &b, const BigInt &mod);
+        static BigInt mul_mod(const BigInt &a, const BigInt &b, const ModContext &context);
+    };
+
+    template <typename T>
+    struct is_expr : std::false_type
+    {
+    };
+
+    struct Leaf;
+    template <typename L, typename R, bool Substract>
+    struct Sum;
+    template <typename E>
+    struct Negate;
+    template <typename L, typename R>
+    struct Product;
+
+    template <>
+    struct is_expr<Leaf> : std::true_type
+    {
+    };
+    template <typename L, typename R, bool Substract>
+    struct is_expr<Sum<L, R, Substract>> : std::true_type
+    {
+    };
+    template <typename E>
+    struct is_expr<Negate<E>> : std::true_type
+    {
+    };
+    template <typename L, typename R>
+    struct is_expr<Product<L, R>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    concept Expr = is_expr<T>::value;
+
+    template <typename T>
+    concept Operand = Expr<T> || std::same_as<T, BigInt>;
+
+    // 求值时收集的项与因子的临时值, 大小在编译期确定
+    template <std::size_t N, std::size_t M>
+    struct Collector
+    {
+        std::array<Term, N> terms;
+        std::array<BigInt, M> temps;
+        std::size_t term_count = 0;
+        std::size_t temp_count = 0;
+    };
+
+    template <Expr E>
+    BigInt evaluate(const E &expr);
+
+    struct Leaf
+    {
+        static constexpr std::size_t TERMS = 1, TEMPS = 0;
+
+        template <typename C>
+        void collect(C &collector, const bool negate) const { collector.terms[collector.term_count++] = {&this->value, nullptr, negate}; }
+
+        operator BigInt() const { return evaluate(*this); }
+
+        const BigInt &value;
+    };
+
+    template <typename L, typename R, bool Substract>
+    struct Sum
+    {
+        static constexpr std::size_t TERMS = L::TERMS + R::TERMS, TEMPS = L::TEMPS + R::TEMPS;
+
+        template <typename C>
+        void collect(C &collector, const bool negate) const
+        {
+            this->left.collect(collector, negate);
+            this->right.collect(collector, negate != Substract);
+        }
+
+        operator BigInt() const { return evaluate(*this); }
+
+        L left;
+        R right;
+    };
+
+    template <typename E>
+    struct Negate
+    {
+        static constexpr std::size_t TERMS = E::TERMS, TEMPS = E::TEMPS;
+
+        template <typename C>
+        void collect(C &collector, const bool negate) const { this->inner.collect(collector, !negate); }
+
+        operator BigInt() const { return evaluate(*this); }
+
+        E inner;
+    };
+
+    // 因子不是单个 BigInt 时先单独求值, 保存在 Collector 的临时值中
+    template <typename E, typename C>
+    const BigInt &factor(const E &expr, C &collector)
+    {
+        if constexpr (std::is_same_v<E, Leaf>)
+            return expr.value;
+        else
+        {
+            collector.temps[collector.temp_count] = evaluate(expr);
+            return collector.temps[collector.temp_count++];
+        }
+    }
+
+    template <typename L, typename R>
+    struct Product
+    {
+        static constexpr std::size_t TERMS = 1, TEMPS = !std::is_same_v<L, Leaf> + !std::is_same_v<R, Leaf>;
+
+        template <typename C>
+        void collect(C &collector, const bool negate) const
+        {
+            const BigInt &a = factor(this->left, collector);
+            const BigInt &b = factor(this->right, collector);
+            collector.terms[collector.term_count++] = {&a, &b, negate};
+        }
+
+        operator BigInt() const { return evaluate(*this); }
+
+        L left;
+        R right;
+    };
+
+    template <Expr E>
+    BigInt evaluate(const E &expr)
+    {
+        Collector<E::TERMS, E::TEMPS> collector;
+        expr.collect(collector, false);
+        return Kernel::sum(std::span<const Term>(collector.terms.data(), collector.term_count));
+    }
+
+    inline Leaf wrap(const BigInt &num) { return Leaf{num}; }
+
+    template <Expr E>
+    const E &wrap(const E &expr) { return expr; }
+
+    template <typename T>
+    using node_t = std::conditional_t<std::is_same_v<T, BigInt>, Leaf, T>;
+
+    // 至少一侧是表达式时才生效, BigInt 之间的运算仍然立即求值
+    template <Operand L, Operand R>
+        requires(Expr<L> || Expr<R>)
+    Sum<node_t<L>, node_t<R>, false> operator+(const L &left, const R &right) { return {wrap(left), wrap(right)}; }
+
+    template <Operand L, Operand R>
+        requires(Expr<L> || Expr<R>)
+    Sum<node_t<L>, node_t<R>, true> operator-(const L &left, const R &right) { return {wrap(left), wrap(right)}; }
+
+    template <Operand L, Operand R>
+        requires(Expr<L> || Expr<R>)
+    Product<node_t<L>, node_t<R>> operator*(const L &left, const R &right) { return {wrap(left), wrap(right)}; }
+
+    template <Expr E>
+    Negate<E> operator-(const E &expr) { return {expr}; }
+
+    template <typename L, typename R>
+    BigInt operator%(const Product<L, R> &product, const BigInt &mod)
+    {
+        Collector<1, Product<L, R>::TEMPS> collector;
+        return Kernel::mul_mod(factor(product.left, collector), factor(product.right, collector), mod);
+    }
+
+    template <typename L, typename R>
+    BigInt operator%(const Product<L, R> &product, const ModContext &context)
+    {
+        Collector<1, Product<L, R>::TEMPS> collector;
+        return Kernel::mul_mod(factor(product.left, collector), factor(product.right, collector), context);
+    }
+
+    template <Expr E>
+    BigInt operator%(const E &expr, const BigInt &mod) { return evaluate(expr) % mod; }
+
+    template <Expr E>
+    BigInt operator%(const E &expr, const ModContext &context) { return context.reduce(evaluate(expr)); }
+}
+
+inline bigexpr::Leaf lazy(const BigInt &num) { return bigexpr::Leaf{num}; }
+#endif
@@ -0,0 +1,113 @@
+#include "BigIntStats.h"
+
+namespace bigint_stats
+{
+#if defined(BIGINT_STATS)
+    namespace
+    {
+        thread_local Snapshot counters;
+        // 当前线程最内层的 Scope, 与各运算正在进行的层数
+        thread_local Scope *current = nullptr;
+        thread_local std::array<std::uint32_t, OP_COUNT> depth{};
+        thread_local std::uint64_t total_allocations = 0;
+        thread_local std::uint64_t total_bytes = 0;
+    }
+#endif
+
+    const char *op_name(const Op op)
+    {
+        static const char *const names[] = {"add", "sub", "mul", "mul_basecase", "mul_karatsuba", "mul_toom3", "mul_ntt", "div", "div_knuth", "div_burnikel_ziegler", "mod_reduce", "parse", "format"};
+        static_assert(sizeof(names) / sizeof(names[0]) == OP_COUNT);
+        return names[static_cast<std::size_t>(op)];
+    }
+
+    Snapshot &Snapshot::operator+=(const Snapshot &other)
+    {
+        for (std::size_t i = 0; i < OP_COUNT; ++i)
+        {
+            Counter &a = this->counters[i];
+            const Counter &b = other.counters[i];
+            a.calls += b.calls;
+            a.limbs += b.limbs;
+            a.nanoseconds += b.nanoseconds;
+            a.self_nanoseconds += b.self_nanoseconds;
+            a.allocations += b.allocations;
+            a.self_allocations += b.self_allocations;
+            a.bytes += b.bytes;
+            a.self_bytes += b.self_bytes;
+        }
+        return *this;
+    }
+
+    Snapshot &Snapshot::operator-=(const Snapshot &other)
+    {
+        for (std::size_t i = 0; i < OP_COUNT; ++i)
+        {
+            Counter &a = this->counters[i];
+            const Counter &b = other.counters[i];
+            a.calls -= b.calls;
+            a.limbs -= b.limbs;
+            a.nanoseconds -= b.nanoseconds;
+            a.self_nanoseconds -= b.self_nanoseconds;
+            a.allocations -= b.allocations;
+            a.self_allocations -= b.self_allocations;
+            a.bytes -= b.bytes;
+            a.self_bytes -= b.self_bytes;
+        }
+        return *this;
+    }
+
+#if defined(BIGINT_STATS)
+    Snapshot snapshot() { return counters; }
+
+    void reset() { counters = Snapshot(); }
+
+    void record_allocation(const std::size_t bytes)
+    {
+        ++total_allocations;
+        total_bytes += bytes;
+    }
+
+    Scope::Scope(const Op op, const std::size_t limbs)
+        : op(op), outermost(depth[static_cast<std::size_t>(op)]++ == 0), parent(current), start(std::chrono::steady_clock::now()), start_allocations(total_allocations), start_bytes(total_bytes)
+    {
+        current = this;
+        Counter &counter = counters[op];
+        ++counter.calls;
+        counter.limbs += limbs;
+    }
+
+    Scope::~Scope()
+    {
+        const std::uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->start).count();
+        const std::uint64_t allocations = total_allocations - this->start_allocations;
+        const std::uint64_t bytes = total_bytes - this->start_bytes;
+
+        Counter &counter = counters[this->op];
+        counter.self_nanoseconds += elapsed - this->child_nanoseconds;
+        counter.self_allocations += allocations - this->child_allocations;
+        counter.self_bytes += bytes - this->child_bytes;
+        if (this->outermost)
+        {
+            counter.nanoseconds += elapsed;
+            counter.allocations += allocations;
+            counter.bytes += bytes;
+        }
+
+        --depth[static_cast<std::size_t>(this->op)];
+        current = this->parent;
+        if (this->parent != nullptr)
+        {
+            this->parent->child_nanoseconds += elapsed;
+            this->parent->child_allocations += allocations;
+            this->parent->child_bytes += bytes;
+        }
+    }
+
+    void Scope::add_limbs(const std::size_t limbs) { counters[this->op].limbs += limbs; }
+#else
+    Snapshot snapshot() { return Snapshot(); }
+
+    void reset() {}
+#endif
+}
@@ -0,0 +1,137 @@
+#ifndef BIGINTSTATSCPP
+#define BIGINTSTATSCPP
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 定义 BIGINT_STATS 时, 按运算类型统计当前线程的调用次数, limb 数, 耗时与 limb 内存的分配
+// 未定义时插桩宏展开为空, limb 分配器也不做包装, 不产生任何开销; snapshot() 返回全零
+// 该宏会改变 BigInt::LimbAllocator, 整个程序需要一致地定义
+namespace bigint_stats
+{
+    enum class Op
+    {
+        add,
+        sub,
+        // mul 与 div 为入口, 其余为具体算法; 递归中的子乘积与子除法计入各自的算法
+        mul,
+        mul_basecase,
+        mul_karatsuba,
+        mul_toom3,
+        mul_ntt,
+        div,
+        div_knuth,
+        div_burnikel_ziegler,
+        // 注入模数后运算结果的隐式约化
+        mod_reduce,
+        // 与字符串, 流以及 (十进制 limb 下) 字节之间的进制转换
+        parse,
+        format,
+        count
+    };
+    inline constexpr std::size_t OP_COUNT = static_cast<std::size_t>(Op::count);
+
+    const char *op_name(const Op op);
+
+    // nanoseconds / allocations / bytes 包含嵌套的其他运算, 同一运算递归时只计最外层
+    // self_ 开头的字段不包含嵌套的运算, 各运算的 self 值之和等于总量
+    struct Counter
+    {
+        std::uint64_t calls = 0;
+        std::uint64_t limbs = 0;
+        std::uint64_t nanoseconds = 0;
+        std::uint64_t self_nanoseconds = 0;
+        std::uint64_t allocations = 0;
+        std::uint64_t self_allocations = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t self_bytes = 0;
+    };
+
+    struct Snapshot
+    {
+        std::array<Counter, OP_COUNT> counters{};
+
+        Counter &operator[](const Op op) { return this->counters[static_cast<std::size_t>(op)]; }
+        const Counter &operator[](const Op op) const { return this->counters[static_cast<std::size_t>(op)]; }
+
+        // 用于合并多个线程的统计, 或求两次快照之间的差
+        Snapshot &operator+=(const Snapshot &other);
+        Snapshot &operator-=(const Snapshot &other);
+    };
+
+    constexpr bool enabled()
+    {
+#if defined(BIGINT_STATS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // 当前线程的累计值
+    Snapshot snapshot();
+    void reset();
+
+#if defined(BIGINT_STATS)
+    void record_allocation(const std::size_t bytes);
+
+    // 在作用域内记录一次运算
+    class Scope
+    {
+    public:
+        Scope(const Op op, const std::size_t limbs);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        // 开始时还不知道规模的运算 (如解析字符串) 在结束前补上
+        void add_limbs(const std::size_t limbs);
+
+    private:
+        Op op;
+        bool outermost;
+        Scope *parent;
+        std::chrono::steady_clock::time_point start;
+        std::uint64_t start_allocations;
+        std::uint64_t start_bytes;
+        std::uint64_t child_nanoseconds = 0;
+        std::uint64_t child_allocations = 0;
+        std::uint64_t child_bytes = 0;
+    };
+
+    // 在 Base 分配时记录次数与字节数
+    template <typename Base>
+    class CountingAllocator : public Base
+    {
+    public:
+        using value_type = typename Base::value_type;
+        template <typename U>
+        struct rebind
+        {
+            using other = CountingAllocator<typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+        };
+
+        using Base::Base;
+        CountingAllocator() = default;
+        CountingAllocator(const Base &base) : Base(base) {}
+
+        value_type *allocate(const std::size_t n)
+        {
+            bigint_stats::record_allocation(n * sizeof(value_type));
+            return std::allocator_traits<Base>::allocate(*this, n);
+        }
+    };
+#endif
+}
+
+#if defined(BIGINT_STATS)
+#define BIGINT_STATS_SCOPE(op, limbs) bigint_stats::Scope bigint_stats_scope(bigint_stats::Op::op, limbs)
+#define BIGINT_STATS_LIMBS(limbs) bigint_stats_scope.add_limbs(limbs)
+#else
+#define BIGINT_STATS_SCOPE(op, limbs) ((void)0)
+#define BIGINT_STATS_LIMBS(limbs) ((void)0)
+#endif
+#endif
@@ -0,0 +1,450 @@
+#ifndef FIXEDBIGINTCPP
+#define FIXEDBIGINTCPP
+#include "BigInt.h"
+#include <array>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace fixed_bigint_detail
+{
+    template <typename T>
+    concept character = std::same_as<T, char> || std::same_as<T, signed char> || std::same_as<T, unsigned char> || std::same_as<T, wchar_t> ||
+                        std::same_as<T, char8_t> || std::same_as<T, char16_t> || std::same_as<T, char32_t>;
+
+    // T 的每个值都不会因为位数不够而被截断; 符号不同时与内置整数一样按 2^Bits 回绕, 不算截断
+    template <typename T, std::size_t Bits, bool Signed>
+    inline constexpr bool widening = !character<T> && static_cast<std::size_t>(std::numeric_limits<T>::digits) <= Bits - (Signed ? 1 : 0);
+}
+
+// 定长整数, Bits 位保存在对象内的 std::array 中, 不分配内存, 也不需要去掉高位的零
+// 全部运算都是 constexpr, 按 limb 的个数在编译期展开; 与内置整数一样按 2^Bits 回绕
+// Signed 为 true 时按补码解释第 Bits - 1 位, 除法向零截断, 右移为算术右移
+// 与 BigInt 之间的转换不丢失信息, 超出范围时抛出异常
+template <std::size_t Bits, bool Signed = false>
+class FixedBigInt
+{
+    static_assert(Bits > 0, "FixedBigInt needs at least one bit");
+
+public:
+    // 定长整数总是使用 2^64 进制, 与 BigInt 的 limb 进制无关
+    using Limb = std::uint64_t;
+    static constexpr std::size_t LIMBS = (Bits + 63) / 64;
+
+    constexpr FixedBigInt() = default;
+
+    // 与内置整数之间的转换相同: 负数按补码扩展
+    // bool 不能转换; 字符类型以及位数可能不够的转换需要显式写出
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    constexpr explicit(!fixed_bigint_detail::widening<T, Bits, Signed>) FixedBigInt(const T value)
+    {
+        // 比 Limb 宽的类型 (如 __int128) 逐个 limb 取出, 有符号数右移时保留符号
+        constexpr std::size_t WORDS = (sizeof(T) + sizeof(Limb) - 1) / sizeof(Limb);
+        if constexpr (std::is_signed_v<T>)
+            this->data.fill(value < 0 ? ~static_cast<Limb>(0) : 0);
+        FixedBigInt::unroll(
+            [&](const std::size_t i)
+            {
+                if (i < WORDS)
+                    this->data[i] = static_cast<Limb>(value >> (64 * i));
+            });
+        this->normalize();
+    }
+
+    // 超出 [min(), max()] 时抛出异常
+    explicit FixedBigInt(const BigInt &num);
+    explicit operator BigInt() const;
+
+    // 低位在前的 limb, 高于 Bits 的位忽略
+    static constexpr FixedBigInt from_limbs(const std::array<Limb, LIMBS> &limbs)
+    {
+        FixedBigInt result;
+        result.data = limbs;
+        result.normalize();
+        return result;
+    }
+    constexpr const std::array<Limb, LIMBS> &limbs() const { return this->data; }
+
+    static constexpr FixedBigInt max()
+    {
+        FixedBigInt result = ~FixedBigInt();
+        if constexpr (Signed)
+            result.set_bit(Bits - 1, false);
+        return result;
+    }
+    static constexpr FixedBigInt min()
+    {
+        FixedBigInt result;
+        if constexpr (Signed)
+            result.set_bit(Bits - 1, true);
+        return result;
+    }
+
+    constexpr bool is_negative() const
+    {
+        if constexpr (Signed)
+            return this->bit(Bits - 1);
+        return false;
+    }
+    constexpr bool is_zero() const
+    {
+        Limb any = 0;
+        FixedBigInt::unroll([&](const std::size_t i) { any |= this->data[i]; });
+        return any == 0;
+    }
+    constexpr bool bit(const std::size_t index) const { return ((this->data[index / 64] >> (index % 64)) & 1) == 1; }
+
+    std::string to_str(const int base = 10) const { return static_cast<BigInt>(*this).to_str(base); }
+
+    constexpr FixedBigInt operator~() const
+    {
+        FixedBigInt result;
+        FixedBigInt::unroll([&](const std::size_t i) { result.data[i] = ~this->data[i]; });
+        result.normalize();
+        return result;
+    }
+    constexpr FixedBigInt operator-() const { return FixedBigInt() - *this; }
+
+    friend constexpr FixedBigInt operator+(const FixedBigInt &a, const FixedBigInt &b)
+    {
+        FixedBigInt result;
+        Limb carry = 0;
+        FixedBigInt::unroll(
+            [&](const std::size_t i)
+            {
+                const Limb sum = a.data[i] + b.data[i];
+                result.data[i] = sum + carry;
+                carry = (sum < a.data[i]) | (result.data[i] < sum);
+            });
+        result.normalize();
+        return result;
+    }
+
+    friend constexpr FixedBigInt operator-(const FixedBigInt &a, const FixedBigInt &b)
+    {
+        FixedBigInt result;
+        Limb borrow = 0;
+        FixedBigInt::unroll(
+            [&](const std::size_t i)
+            {
+                const Limb diff = a.data[i] - b.data[i];
+                result.data[i] = diff - borrow;
+                borrow = (a.data[i] < b.data[i]) | (diff < borrow);
+            });
+        result.normalize();
+        return result;
+    }
+
+    // 只计算低 LIMBS 个 limb
+    friend constexpr FixedBigInt operator*(const FixedBigInt &a, const FixedBigInt &b)
+    {
+        FixedBigInt result;
+        FixedBigInt::unroll(
+            [&](const std::size_t i)
+            {
+                Limb carry = 0;
+                FixedBigInt::unroll(
+                    [&](const std::size_t k)
+                    {
+                        if (k < i)
+                            return;
+                        // 最高的 limb 不需要进位
+                        if (k == LIMBS - 1)
+                        {
+                            result.data[k] += a.data[i] * b.data[k - i] + carry;
+                            return;
+                        }
+                        const Wide cur = static_cast<Wide>(a.data[i]) * b.data[k - i] + result.data[k] + carry;
+                        result.data[k] = static_cast<Limb>(cur);
+                        carry = static_cast<Limb>(cur >> 64);
+                    });
+            });
+        result.normalize();
+        return result;
+    }
+
+    // 商向零截断, 余数与被除数同号; 除数为零时抛出异常
+    static constexpr std::pair<FixedBigInt, FixedBigInt> divmod(const FixedBigInt &a, const FixedBigInt &b)
+    {
+        if (b.is_zero())
+            throw std::runtime_error("divided by zero");
+
+        const bool a_negative = a.is_negative(), b_negative = b.is_negative();
+        std::pair<FixedBigInt, FixedBigInt> result;
+        FixedBigInt::divmod_unsigned(a_negative ? -a : a, b_negative ? -b : b, result.first, result.second);
+        if (a_negative != b_negative)
+            result.first = -result.first;
+        if (a_negative)
+            result.second = -result.second;
+        return result;
+    }
+    friend constexpr FixedBigInt operator/(const FixedBigInt &a, const FixedBigInt &b) { return FixedBigInt::divmod(a, b).first; }
+    friend constexpr FixedBigInt operator%(const FixedBigInt &a, const FixedBigInt &b) { return FixedBigInt::divmod(a, b).second; }
+
+    friend constexpr FixedBigInt operator&(const FixedBigInt &a, const FixedBigInt &b)
+    {
+        FixedBigInt result;
+        FixedBigInt::unroll([&](const std::size_t i) { result.data[i] = a.data[i] & b.data[i]; });
+        return result;
+    }
+    friend constexpr FixedBigInt operator|(const FixedBigInt &a, const FixedBigInt &b)
+    {
+        FixedBigInt result;
+        FixedBigInt::unroll([&](const std::size_t i) { result.data[i] = a.data[i] | b.data[i]; });
+        return result;
+    }
+    friend constexpr FixedBigInt operator^(const FixedBigInt &a, const FixedBigInt &b)
+    {
+        FixedBigInt result;
+        FixedBigInt::unroll([&](const std::size_t i) { result.data[i] = a.data[i] ^ b.data[i]; });
+        return result;
+    }
+
+    // 移位数不小于 Bits 时结果为 0, 有符号负数右移时为 -1
+    constexpr FixedBigInt operator<<(const std::size_t shift) const
+    {
+        FixedBigInt result;
+        if (shift >= Bits)
+            return result;
+        const std::size_t limbs = shift / 64, bits = shift % 64;
+        FixedBigInt::unroll(
+            [&](const std::size_t i)
+            {
+                if (i < limbs)
+                    return;
+                Limb value = this->data[i - limbs] << bits;
+                if (bits != 0 && i > limbs)
+                    value |= this->data[i - limbs - 1] >> (64 - bits);
+                result.data[i] = value;
+            });
+        result.normalize();
+        return result;
+    }
+
+    constexpr FixedBigInt operator>>(const std::size_t shift) const
+    {
+        // 负数先把符号位扩展到最高 limb 的空闲位
+        const Limb fill = this->is_negative() ? ~static_cast<Limb>(0) : 0;
+        std::array<Limb, LIMBS> source = this->data;
+        source[LIMBS - 1] |= fill & ~TOP_MASK;
+
+        FixedBigInt result;
+        result.data.fill(fill);
+        if (shift >= Bits)
+        {
+            result.normalize();
+            return result;
+        }
+        const std::size_t limbs = shift / 64, bits = shift % 64;
+        FixedBigInt::unroll(
+            [&](const std::size_t i)
+            {
+                if (i + limbs >= LIMBS)
+                    return;
+                Limb value = source[i + limbs] >> bits;
+                if (bits != 0)
+                    value |= ((i + limbs + 1 < LIMBS) ? source[i + limbs + 1] : fill) << (64 - bits);
+                result.data[i] = value;
+            });
+        result.normalize();
+        return result;
+    }
+
+    constexpr FixedBigInt &operator+=(const FixedBigInt &num) { return *this = *this + num; }
+    constexpr FixedBigInt &operator-=(const FixedBigInt &num) { return *this = *this - num; }
+    constexpr FixedBigInt &operator*=(const FixedBigInt &num) { return *this = *this * num; }
+    constexpr FixedBigInt &operator/=(const FixedBigInt &num) { return *this = *this / num; }
+    constexpr FixedBigInt &operator%=(const FixedBigInt &num) { return *this = *this % num; }
+    constexpr FixedBigInt &operator&=(const FixedBigInt &num) { return *this = *this & num; }
+    constexpr FixedBigInt &operator|=(const FixedBigInt &num) { return *this = *this | num; }
+    constexpr FixedBigInt &operator^=(const FixedBigInt &num) { return *this = *this ^ num; }
+    constexpr FixedBigInt &operator<<=(const std::size_t shift) { return *this = *this << shift; }
+    constexpr FixedBigInt &operator>>=(const std::size_t shift) { return *this = *this >> shift; }
+
+    friend constexpr bool operator==(const FixedBigInt &a, const FixedBigInt &b) = default;
+
+    friend constexpr std::strong_ordering operator<=>(const FixedBigInt &a, const FixedBigInt &b)
+    {
+        if (a.is_negative() != b.is_negative())
+            return a.is_negative() ? std::strong_ordering::less : std::strong_ordering::greater;
+        // 同号时补码的大小顺序与无符号相同, 从高位起第一个不同的 limb 决定结果
+        std::strong_ordering result = std::strong_ordering::equal;
+        FixedBigInt::unroll(
+            [&](const std::size_t i)
+            {
+                const std::size_t k = LIMBS - 1 - i;
+                if (result == 0)
+                    result = a.data[k] <=> b.data[k];
+            });
+        return result;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const FixedBigInt &num) { return os << static_cast<BigInt>(num); }
+
+private:
+    using Wide = unsigned __int128;
+    static constexpr Limb TOP_MASK = (Bits % 64 == 0) ? ~static_cast<Limb>(0) : (static_cast<Limb>(1) << (Bits % 64)) - 1;
+
+    // 对每个 limb 下标调用 f, 在编译期展开
+    template <typename F>
+    static constexpr void unroll(F &&f)
+    {
+        [&]<std::size_t... I>(std::index_sequence<I...>) { (f(I), ...); }(std::make_index_sequence<LIMBS>());
+    }
+
+    // 清除高于 Bits 的位
+    constexpr void normalize() { this->data[LIMBS - 1] &= TOP_MASK; }
+
+    constexpr void set_bit(const std::size_t index, const bool value)
+    {
+        const Limb mask = static_cast<Limb>(1) << (index % 64);
+        this->data[index / 64] = value ? (this->data[index / 64] | mask) : (this->data[index / 64] & ~mask);
+    }
+
+    // 把 a, b 当作无符号数的 Knuth Algorithm D
+    static constexpr void divmod_unsigned(const FixedBigInt &a, const FixedBigInt &b, FixedBigInt &quot, FixedBigInt &rem)
+    {
+        quot = FixedBigInt();
+        rem = FixedBigInt();
+        std::size_t m = LIMBS, n = LIMBS;
+        while (m > 0 && a.data[m - 1] == 0)
+            --m;
+        while (n > 1 && b.data[n - 1] == 0)
+            --n;
+        if (m < n)
+        {
+            rem = a;
+            return;
+        }
+
+        // 高于 m, n 的 limb 都是 0, 因此逐 limb 的部分按 LIMBS 展开; 只有求商的循环依赖 m, n
+        if (n == 1)
+        {
+            Wide r = 0;
+            FixedBigInt::unroll(
+                [&](const std::size_t i)
+                {
+                    const std::size_t k = LIMBS - 1 - i;
+                    const Wide cur = (r << 64) | a.data[k];
+                    quot.data[k] = static_cast<Limb>(cur / b.data[0]);
+                    r = cur % b.data[0];
+                });
+            rem.data[0] = static_cast<Limb>(r);
+            return;
+        }
+
+        // 归一化: 使除数最高 limb 的最高位为 1, 移出的位都是 0
+        const unsigned shift = std::countl_zero(b.data[n - 1]);
+        std::array<Limb, LIMBS + 1> u{};
+        std::array<Limb, LIMBS> v{};
+        FixedBigInt::unroll(
+            [&](const std::size_t i)
+            {
+                v[i] = (b.data[i] << shift) | ((shift != 0 && i > 0) ? b.data[i - 1] >> (64 - shift) : 0);
+                u[i] = (a.data[i] << shift) | ((shift != 0 && i > 0) ? a.data[i - 1] >> (64 - shift) : 0);
+            });
+        u[LIMBS] = (shift != 0) ? a.data[LIMBS - 1] >> (64 - shift) : 0;
+
+        const Wide base = static_cast<Wide>(1) << 64;
+        for (std::size_t j = m - n + 1; j-- > 0;)
+        {
+            const Wide top = (static_cast<Wide>(u[j + n]) << 64) | u[j + n - 1];
+            Wide q_hat = top / v[n - 1];
+            Wide r_hat = top % v[n - 1];
+            while (q_hat >= base || q_hat * v[n - 2] > ((r_hat << 64) | u[j + n - 2]))
+            {
+                --q_hat;
+                r_hat += v[n - 1];
+                if (r_hat >= base)
+                    break;
+            }
+
+            // u[j..j+n] -= q_hat * v
+            Limb borrow = 0, carry = 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const Wide product = q_hat * v[i] + carry;
+                carry = static_cast<Limb>(product >> 64);
+                const Limb low = static_cast<Limb>(product);
+                const Limb diff = u[i + j] - low;
+                const Limb next = diff - borrow;
+                borrow = (u[i + j] < low) | (diff < borrow);
+                u[i + j] = next;
+            }
+            const Limb diff = u[j + n] - carry;
+            const bool negative = (u[j + n] < carry) || (diff < borrow);
+            u[j + n] = diff - borrow;
+
+            // 估计偏大, 加回一次
+            if (negative)
+            {
+                --q_hat;
+                Limb add_carry = 0;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    const Wide sum = static_cast<Wide>(u[i + j]) + v[i] + add_carry;
+                    u[i + j] = static_cast<Limb>(sum);
+                    add_carry = static_cast<Limb>(sum >> 64);
+                }
+                u[j + n] += add_carry;
+            }
+            quot.data[j] = static_cast<Limb>(q_hat);
+        }
+
+        // 余数小于除数, u 中第 n 个及更高的 limb 都已经是 0
+        FixedBigInt::unroll([&](const std::size_t i) { rem.data[i] = (u[i] >> shift) | ((shift != 0) ? u[i + 1] << (64 - shift) : 0); });
+    }
+
+private:
+    std::array<Limb, LIMBS> data{};
+};
+
+template <std::size_t Bits, bool Signed>
+FixedBigInt<Bits, Signed>::FixedBigInt(const BigInt &num)
+{
+    // 先按绝对值转换, 再检查范围并处理符号
+    std::array<std::byte, LIMBS * 8> bytes{};
+    if (num.byte_size() > bytes.size())
+        throw std::runtime_error("value does not fit in FixedBigInt");
+    const std::size_t size = num.to_bytes(bytes, std::endian::little);
+    for (std::size_t i = 0; i < size; ++i)
+        this->data[i / 8] |= static_cast<Limb>(std::to_integer<unsigned>(bytes[i])) << (8 * (i % 8));
+    if ((this->data[LIMBS - 1] & ~TOP_MASK) != 0)
+        throw std::runtime_error("value does not fit in FixedBigInt");
+
+    const bool negative = num < BigInt();
+    if (negative)
+    {
+        if constexpr (!Signed)
+            throw std::runtime_error("value does not fit in FixedBigInt");
+        *this = -*this;
+    }
+    // 有符号时绝对值不能超过 2^(Bits - 1), 只有负数可以取到
+    if (Signed && !this->is_zero() && this->is_negative() != negative)
+        throw std::runtime_error("value does not fit in FixedBigInt");
+}
+
+template <std::size_t Bits, bool Signed>
+FixedBigInt<Bits, Signed>::operator BigInt() const
+{
+    const bool negative = this->is_negative();
+    const FixedBigInt magnitude = negative ? -*this : *this;
+    std::array<std::byte, LIMBS * 8> bytes;
+    for (std::size_t i = 0; i < bytes.size(); ++i)
+        bytes[i] = static_cast<std::byte>(magnitude.data[i / 8] >> (8 * (i % 8)));
+    // 补码的最小值取反后仍是自身, 按无符号解释正好是它的绝对值
+    const BigInt result = BigInt::from_bytes(bytes, std::endian::little);
+    return negative ? -result : result;
+}
+
+template <std::size_t Bits>
+using FixedInt = FixedBigInt<Bits, true>;
+template <std::size_t Bits>
+using FixedUInt = FixedBigInt<Bits, false>;
+#endif
@@ -0,0 +1,214 @@
+#include "MappedBigInt.h"
+#include <cstring>
+#include <stdexcept>
+#if __has_include(<sys/mman.h>)
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BIGINT_HAS_MMAP 1
+#endif
+
+namespace
+{
+    constexpr char MAGIC[8] = {'B', 'I', 'G', 'I', 'N', 'T', '\x1a', '\n'};
+
+    // limb 的进制
+    enum : std::uint8_t
+    {
+        RADIX_DECIMAL = 0,
+        RADIX_BINARY = 1
+    };
+
+    // magic 与 endian 按字节比较, 其余字段使用 endian 记录的字节序
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint8_t radix;
+        std::uint8_t limb_bytes;
+        std::uint8_t endian;
+        std::uint8_t negative;
+        std::uint64_t limb_count;
+        std::uint8_t reserved[40];
+    };
+    static_assert(sizeof(FileHeader) == 64, "limb 从 64 字节处开始, 保证对齐");
+
+    FileHeader make_header(const bool negative, const std::size_t limb_count)
+    {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = MappedBigInt::VERSION;
+#if defined(BIGINT_BINARY_LIMBS)
+        header.radix = RADIX_BINARY;
+#else
+        header.radix = RADIX_DECIMAL;
+#endif
+        header.limb_bytes = sizeof(BigInt::DataType);
+        header.endian = (std::endian::native == std::endian::little) ? 0 : 1;
+        header.negative = negative ? 1 : 0;
+        header.limb_count = limb_count;
+        return header;
+    }
+
+    void check_header(const FileHeader &header, const std::size_t file_size)
+    {
+        const FileHeader expect = make_header(false, 0);
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+            throw std::runtime_error("not a BigInt file");
+        if (header.endian != expect.endian)
+            throw std::runtime_error("BigInt file has a different byte order");
+        if (header.version != MappedBigInt::VERSION)
+            throw std::runtime_error("unsupported BigInt file version: " + std::to_string(header.version));
+        if (header.radix != expect.radix || header.limb_bytes != expect.limb_bytes)
+            throw std::runtime_error("BigInt file has a different limb radix");
+        if (header.limb_count > (file_size - sizeof(FileHeader)) / sizeof(BigInt::DataType))
+            throw std::runtime_error("truncated BigInt file");
+    }
+
+    // 加载时检查一遍 limb, 之后的运算都假定 limb 在进制范围内
+    void check_limbs(std::span<const BigInt::DataType> limbs)
+    {
+#if defined(BIGINT_BINARY_LIMBS)
+        (void)limbs;
+#else
+        for (const BigInt::DataType limb : limbs)
+        {
+            if (limb >= mpn::LIMIT)
+                throw std::runtime_error("BigInt file has a limb out of range");
+        }
+#endif
+    }
+}
+
+MappedBigInt::MappedBigInt(const std::string &path)
+{
+#if defined(BIGINT_HAS_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(FileHeader))
+    {
+        ::close(fd);
+        throw std::runtime_error("not a BigInt file");
+    }
+    this->length = static_cast<std::size_t>(info.st_size);
+    this->address = ::mmap(nullptr, this->length, PROT_READ, MAP_SHARED, fd, 0);
+    // 映射建立后不再需要文件描述符
+    ::close(fd);
+    if (this->address == MAP_FAILED)
+    {
+        this->address = nullptr;
+        throw std::runtime_error("cannot map " + path);
+    }
+
+    const FileHeader &header = *static_cast<const FileHeader *>(this->address);
+    const DataType *first = reinterpret_cast<const DataType *>(static_cast<const char *>(this->address) + sizeof(FileHeader));
+    try
+    {
+        check_header(header, this->length);
+        check_limbs(std::span<const DataType>(first, header.limb_count));
+    }
+    catch (...)
+    {
+        this->unmap();
+        throw;
+    }
+
+    std::size_t count = header.limb_count;
+    // 与 BigInt 一致, 不保留高位的 0
+    while (count > 0 && first[count - 1] == 0)
+        --count;
+    this->data = std::span<const DataType>(first, count);
+    this->negative = header.negative != 0 && count > 0;
+#else
+    throw std::runtime_error("memory mapped files are not supported on this platform: " + path);
+#endif
+}
+
+MappedBigInt::~MappedBigInt() { this->unmap(); }
+
+MappedBigInt::MappedBigInt(MappedBigInt &&other) : address(other.address), length(other.length), negative(other.negative), data(other.data)
+{
+    other.address = nullptr;
+    other.length = 0;
+    other.data = {};
+}
+
+MappedBigInt &MappedBigInt::operator=(MappedBigInt &&other)
+{
+    if (this != &other)
+    {
+        this->unmap();
+        std::swap(this->address, other.address);
+        std::swap(this->length, other.length);
+        std::swap(this->negative, other.negative);
+        std::swap(this->data, other.data);
+    }
+    return *this;
+}
+
+void MappedBigInt::unmap()
+{
+#if defined(BIGINT_HAS_MMAP)
+    if (this->address != nullptr)
+        ::munmap(this->address, this->length);
+#endif
+    this->address = nullptr;
+    this->length = 0;
+    this->data = {};
+}
+
+bool MappedBigInt::is_negative() const { return this->negative; }
+
+std::span<const MappedBigInt::DataType> MappedBigInt::limbs() const { return this->data; }
+
+BigIntView MappedBigInt::view() const { return BigIntView(this->negative, this->data); }
+
+BigInt MappedBigInt::value() const { return BigInt(this->view()); }
+
+void MappedBigInt::save(const std::string &path, const BigInt &num)
+{
+#if defined(BIGINT_HAS_MMAP)
+    const std::string temp = path + ".tmp";
+    const std::size_t bytes = num.data.size() * sizeof(DataType);
+    const std::size_t size = sizeof(FileHeader) + bytes;
+
+    const int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw std::runtime_error("cannot create " + temp);
+    const auto fail = [&](const std::string &message)
+    {
+        ::close(fd);
+        ::unlink(temp.c_str());
+        throw std::runtime_error(message);
+    };
+
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+        fail("cannot resize " + temp);
+    void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+        fail("cannot map " + temp);
+
+    const FileHeader header = make_header(num.negative, num.data.size());
+    std::memcpy(address, &header, sizeof(header));
+    if (bytes != 0)
+        std::memcpy(static_cast<char *>(address) + sizeof(FileHeader), num.data.data(), bytes);
+    const bool synced = ::msync(address, size, MS_SYNC) == 0;
+    ::munmap(address, size);
+    if (!synced || ::fsync(fd) != 0)
+        fail("cannot write " + temp);
+    ::close(fd);
+
+    if (std::rename(temp.c_str(), path.c_str()) != 0)
+    {
+        ::unlink(temp.c_str());
+        throw std::runtime_error("cannot rename " + temp + " to " + path);
+    }
+#else
+    (void)num;
+    throw std::runtime_error("memory mapped files are not supported on this platform: " + path);
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef MAPPEDBIGINTCPP
+#define MAPPEDBIGINTCPP
+#include "BigInt.h"
+#include <string>
+
+// 以内存映射方式读写的 BigInt 文件
+// 文件由 64 字节的头部和紧随其后的 limb 组成, limb 按当前平台的字节序原样保存, 读取时不做复制与转换
+// 头部记录版本, 符号, limb 个数, limb 进制与字节序, 与当前构建不一致的文件会被拒绝
+class MappedBigInt
+{
+public:
+    using DataType = BigInt::DataType;
+
+    static constexpr std::uint32_t VERSION = 1;
+
+    // 只读映射 path, 头部不合法或十进制 limb 不小于 LIMIT 时抛出异常; 高位的 0 limb 会被忽略
+    explicit MappedBigInt(const std::string &path);
+    ~MappedBigInt();
+
+    MappedBigInt(MappedBigInt &&other);
+    MappedBigInt &operator=(MappedBigInt &&other);
+    MappedBigInt(const MappedBigInt &) = delete;
+    MappedBigInt &operator=(const MappedBigInt &) = delete;
+
+    bool is_negative() const;
+    // 低位在前, 直接指向映射的页面, 在对象析构前有效
+    std::span<const DataType> limbs() const;
+    // 可以直接作为运算的操作数, 不复制映射的 limb
+    BigIntView view() const;
+    // 复制为普通的 BigInt
+    BigInt value() const;
+
+    // 通过可写的映射写入 path; 先写入 path.tmp 并落盘, 再重命名为 path, 中途失败不会破坏已有的文件
+    static void save(const std::string &path, const BigInt &num);
+
+private:
+    void unmap();
+
+private:
+    void *address = nullptr;
+    std::size_t length = 0;
+    bool negative = false;
+    std::span<const DataType> data;
+};
+#endif
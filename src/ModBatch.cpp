@@ -0,0 +1,418 @@
+#include "ModContext.h"
+#include "TaskPool.h"
+#include <bit>
+#include <functional>
+
+// 与 MpnSimd.cpp 相同, 只在 x86-64 的 GCC/Clang 下编译向量内核
+#if !defined(BIGINT_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MODBATCH_SIMD
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#endif
+
+namespace
+{
+    // 结构数组布局: 一组 LANES 个数, 第 j 个 digit 的各 lane 连续存放在 [j * LANES, (j + 1) * LANES), 每个 digit 占一个 64 位槽
+    // digit 取 28 位: 两个乘积之和小于 2^57, 在 64 位槽中累加 64 轮也不会溢出, 内层循环因此没有进位链, 各 lane 之间也互不依赖
+    constexpr std::size_t LANES = 8;
+    constexpr unsigned BITS = 28;
+    constexpr std::uint64_t MASK = (std::uint64_t(1) << BITS) - 1;
+    // 每隔多少轮把累加的 digit 规范化一次
+    constexpr std::size_t NORMALIZE_ROUNDS = 64;
+    // 每个任务处理的组数
+    constexpr std::size_t GROUPS_PER_TASK = 64;
+
+    // 以 2^BITS 为进制的 Montgomery 参数, R = 2^(BITS * n)
+    struct Montgomery
+    {
+        std::size_t n;
+        std::vector<std::uint64_t> mod;
+        std::uint64_t mod_inv;
+    };
+
+    // out = a * b * R^(-1) mod mod, 要求 a, b < mod; t 至少有 (n + 1) * LANES 个槽
+    using Kernel = void (*)(std::uint64_t *out, const std::uint64_t *a, const std::uint64_t *b, const Montgomery &ctx, std::uint64_t *t);
+
+    // 小端的 Word 数组按 BITS 位切分, 第 k 个 digit 写入 out[k * stride]
+    template <typename Word>
+    void split_digits(const Word *words, const std::size_t count, std::uint64_t *out, const std::size_t stride, const std::size_t n)
+    {
+        constexpr std::size_t WORD_BITS = 8 * sizeof(Word);
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            const std::size_t w = k * BITS / WORD_BITS, offset = k * BITS % WORD_BITS;
+            if (w >= count)
+                break;
+            std::uint64_t digit = static_cast<std::uint64_t>(words[w]) >> offset;
+            if (offset + BITS > WORD_BITS && w + 1 < count)
+                digit |= static_cast<std::uint64_t>(words[w + 1]) << (WORD_BITS - offset);
+            out[k * stride] = digit & MASK;
+        }
+    }
+
+    // split_digits 的逆运算, words 需要预先清零
+    template <typename Word>
+    void join_digits(const std::uint64_t *digits, const std::size_t stride, const std::size_t n, Word *words, const std::size_t count)
+    {
+        constexpr std::size_t WORD_BITS = 8 * sizeof(Word);
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            const std::uint64_t digit = digits[k * stride];
+            const std::size_t w = k * BITS / WORD_BITS, offset = k * BITS % WORD_BITS;
+            if (w < count)
+                words[w] |= static_cast<Word>(digit << offset);
+            if (offset + BITS > WORD_BITS && w + 1 < count)
+                words[w + 1] |= static_cast<Word>(digit >> (WORD_BITS - offset));
+        }
+    }
+
+#if !defined(BIGINT_BINARY_LIMBS)
+    // 十进制 limb 按 Horner 法则转为 digit: digits = digits * LIMIT + limb; out 需要预先清零
+    void split_decimal(const mpn::Limb *limbs, const std::size_t count, std::uint64_t *out, const std::size_t stride, const std::size_t n)
+    {
+        std::size_t used = 0;
+        for (std::size_t k = count; k-- > 0;)
+        {
+            std::uint64_t carry = limbs[k];
+            for (std::size_t j = 0; j < used; ++j)
+            {
+                const std::uint64_t s = out[j * stride] * mpn::LIMIT + carry;
+                out[j * stride] = s & MASK;
+                carry = s >> BITS;
+            }
+            for (; carry != 0 && used < n; ++used)
+            {
+                out[used * stride] = carry & MASK;
+                carry >>= BITS;
+            }
+        }
+    }
+
+    // 反方向: limbs = limbs * 2^BITS + digit, 返回使用的 limb 数; LIMIT > 2^29, limbs 有 n * BITS / 29 + 1 个即可
+    std::size_t join_decimal(const std::uint64_t *digits, const std::size_t stride, const std::size_t n, mpn::Limb *limbs)
+    {
+        std::size_t used = 0;
+        for (std::size_t k = n; k-- > 0;)
+        {
+            std::uint64_t carry = digits[k * stride];
+            for (std::size_t j = 0; j < used; ++j)
+            {
+                const std::uint64_t s = (static_cast<std::uint64_t>(limbs[j]) << BITS) + carry;
+                limbs[j] = static_cast<mpn::Limb>(s % mpn::LIMIT);
+                carry = s / mpn::LIMIT;
+            }
+            for (; carry != 0; ++used)
+            {
+                limbs[used] = static_cast<mpn::Limb>(carry % mpn::LIMIT);
+                carry /= mpn::LIMIT;
+            }
+        }
+        return used;
+    }
+#endif
+
+    // 每轮 t = (t + a * b[i] + q * mod) / 2^BITS, 其中 q 使 t[0] 的低 BITS 位为 0; 各 digit 只累加不进位
+    // 结束后 t < 2 * mod, 规范化后再按需减去一次 mod
+    void montgomery_scalar(std::uint64_t *out, const std::uint64_t *a, const std::uint64_t *b, const Montgomery &ctx, std::uint64_t *t)
+    {
+        const std::size_t n = ctx.n;
+        const std::uint64_t *m = ctx.mod.data();
+        for (std::size_t l = 0; l < LANES; ++l)
+        {
+            std::fill(t, t + n + 1, 0);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const std::uint64_t bi = b[i * LANES + l];
+                const std::uint64_t t0 = t[0] + a[l] * bi;
+                const std::uint64_t q = (t0 * ctx.mod_inv) & MASK;
+                const std::uint64_t carry = (t0 + q * m[0]) >> BITS;
+                for (std::size_t j = 1; j < n; ++j)
+                    t[j - 1] = t[j] + a[j * LANES + l] * bi + q * m[j];
+                t[n - 1] = 0;
+                t[0] += carry;
+
+                // 进位累加到最高的 digit 中, 它的值不超过 2 * 2^BITS
+                if (i % NORMALIZE_ROUNDS == NORMALIZE_ROUNDS - 1)
+                {
+                    for (std::size_t j = 0; j + 1 < n; ++j)
+                    {
+                        t[j + 1] += t[j] >> BITS;
+                        t[j] &= MASK;
+                    }
+                }
+            }
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                t[j + 1] += t[j] >> BITS;
+                t[j] &= MASK;
+            }
+
+            std::uint64_t borrow = 0;
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                const std::uint64_t d = t[j] - m[j] - borrow;
+                out[j * LANES + l] = d & MASK;
+                borrow = d >> 63;
+            }
+            if (borrow > t[n])
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                    out[j * LANES + l] = t[j];
+            }
+        }
+    }
+
+#if defined(MODBATCH_SIMD)
+    // 第 j 个 digit 的第 h 组 4 个 lane
+    __attribute__((target("avx2"))) inline __m256i load4(const std::uint64_t *p, const std::size_t j, const std::size_t h) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + j * LANES + 4 * h)); }
+
+    __attribute__((target("avx2"))) inline void store4(std::uint64_t *p, const std::size_t j, const std::size_t h, const __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p + j * LANES + 4 * h), v); }
+
+    // t[0, last) 的进位依次加到下一个 digit
+    __attribute__((target("avx2"))) void normalize_avx2(std::uint64_t *t, const std::size_t last)
+    {
+        const __m256i mask = _mm256_set1_epi64x(MASK);
+        for (std::size_t h = 0; h < 2; ++h)
+        {
+            for (std::size_t j = 0; j < last; ++j)
+            {
+                const __m256i v = load4(t, j, h);
+                store4(t, j, h, _mm256_and_si256(v, mask));
+                store4(t, j + 1, h, _mm256_add_epi64(load4(t, j + 1, h), _mm256_srli_epi64(v, BITS)));
+            }
+        }
+    }
+
+    // 与标量内核相同的运算, 8 个 lane 分为两个向量
+    __attribute__((target("avx2"))) void montgomery_avx2(std::uint64_t *out, const std::uint64_t *a, const std::uint64_t *b, const Montgomery &ctx, std::uint64_t *t)
+    {
+        const std::size_t n = ctx.n;
+        const __m256i mask = _mm256_set1_epi64x(MASK), mod_inv = _mm256_set1_epi64x(ctx.mod_inv), m0 = _mm256_set1_epi64x(ctx.mod[0]), zero = _mm256_setzero_si256();
+
+        std::fill(t, t + (n + 1) * LANES, 0);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            __m256i bi[2], q[2], carry[2];
+            for (std::size_t h = 0; h < 2; ++h)
+            {
+                bi[h] = load4(b, i, h);
+                const __m256i t0 = _mm256_add_epi64(load4(t, 0, h), _mm256_mul_epu32(load4(a, 0, h), bi[h]));
+                q[h] = _mm256_and_si256(_mm256_mul_epu32(t0, mod_inv), mask);
+                carry[h] = _mm256_srli_epi64(_mm256_add_epi64(t0, _mm256_mul_epu32(q[h], m0)), BITS);
+            }
+            for (std::size_t j = 1; j < n; ++j)
+            {
+                const __m256i mj = _mm256_set1_epi64x(ctx.mod[j]);
+                for (std::size_t h = 0; h < 2; ++h)
+                    store4(t, j - 1, h, _mm256_add_epi64(_mm256_add_epi64(load4(t, j, h), _mm256_mul_epu32(load4(a, j, h), bi[h])), _mm256_mul_epu32(q[h], mj)));
+            }
+            for (std::size_t h = 0; h < 2; ++h)
+            {
+                store4(t, n - 1, h, zero);
+                store4(t, 0, h, _mm256_add_epi64(load4(t, 0, h), carry[h]));
+            }
+
+            if (i % NORMALIZE_ROUNDS == NORMALIZE_ROUNDS - 1)
+                normalize_avx2(t, n - 1);
+        }
+        normalize_avx2(t, n);
+
+        // 逐 lane 减去 mod, 结果为负 (借位多于 t 的最高 digit) 的 lane 保留 t
+        for (std::size_t h = 0; h < 2; ++h)
+        {
+            __m256i borrow = zero;
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                const __m256i d = _mm256_sub_epi64(_mm256_sub_epi64(load4(t, j, h), _mm256_set1_epi64x(ctx.mod[j])), borrow);
+                store4(out, j, h, _mm256_and_si256(d, mask));
+                borrow = _mm256_srli_epi64(d, 63);
+            }
+            const __m256i keep = _mm256_sub_epi64(zero, _mm256_andnot_si256(load4(t, n, h), borrow));
+            for (std::size_t j = 0; j < n; ++j)
+                store4(out, j, h, _mm256_or_si256(_mm256_and_si256(keep, load4(t, j, h)), _mm256_andnot_si256(keep, load4(out, j, h))));
+        }
+    }
+
+    __attribute__((target("avx512f"))) inline __m512i load8(const std::uint64_t *p, const std::size_t j) { return _mm512_loadu_si512(p + j * LANES); }
+
+    __attribute__((target("avx512f"))) inline void store8(std::uint64_t *p, const std::size_t j, const __m512i v) { _mm512_storeu_si512(p + j * LANES, v); }
+
+    __attribute__((target("avx512f"))) void normalize_avx512(std::uint64_t *t, const std::size_t last)
+    {
+        const __m512i mask = _mm512_set1_epi64(MASK);
+        for (std::size_t j = 0; j < last; ++j)
+        {
+            const __m512i v = load8(t, j);
+            store8(t, j, _mm512_and_si512(v, mask));
+            store8(t, j + 1, _mm512_add_epi64(load8(t, j + 1), _mm512_srli_epi64(v, BITS)));
+        }
+    }
+
+    __attribute__((target("avx512f"))) void montgomery_avx512(std::uint64_t *out, const std::uint64_t *a, const std::uint64_t *b, const Montgomery &ctx, std::uint64_t *t)
+    {
+        const std::size_t n = ctx.n;
+        const __m512i mask = _mm512_set1_epi64(MASK), mod_inv = _mm512_set1_epi64(ctx.mod_inv), m0 = _mm512_set1_epi64(ctx.mod[0]);
+
+        std::fill(t, t + (n + 1) * LANES, 0);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const __m512i bi = load8(b, i);
+            const __m512i t0 = _mm512_add_epi64(load8(t, 0), _mm512_mul_epu32(load8(a, 0), bi));
+            const __m512i q = _mm512_and_si512(_mm512_mul_epu32(t0, mod_inv), mask);
+            const __m512i carry = _mm512_srli_epi64(_mm512_add_epi64(t0, _mm512_mul_epu32(q, m0)), BITS);
+            for (std::size_t j = 1; j < n; ++j)
+                store8(t, j - 1, _mm512_add_epi64(_mm512_add_epi64(load8(t, j), _mm512_mul_epu32(load8(a, j), bi)), _mm512_mul_epu32(q, _mm512_set1_epi64(ctx.mod[j]))));
+            store8(t, n - 1, _mm512_setzero_si512());
+            store8(t, 0, _mm512_add_epi64(load8(t, 0), carry));
+
+            if (i % NORMALIZE_ROUNDS == NORMALIZE_ROUNDS - 1)
+                normalize_avx512(t, n - 1);
+        }
+        normalize_avx512(t, n);
+
+        __m512i borrow = _mm512_setzero_si512();
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            const __m512i d = _mm512_sub_epi64(_mm512_sub_epi64(load8(t, j), _mm512_set1_epi64(ctx.mod[j])), borrow);
+            store8(out, j, _mm512_and_si512(d, mask));
+            borrow = _mm512_srli_epi64(d, 63);
+        }
+        const __m512i negative = _mm512_andnot_si512(load8(t, n), borrow);
+        const __mmask8 keep = _mm512_test_epi64_mask(negative, negative);
+        for (std::size_t j = 0; j < n; ++j)
+            store8(out, j, _mm512_mask_mov_epi64(load8(out, j), keep, load8(t, j)));
+    }
+#endif
+
+    // 与 mpn 的 add_n 等内核使用同一个指令集选择
+    Kernel select_kernel()
+    {
+#if defined(MODBATCH_SIMD)
+        switch (mpn::active_isa())
+        {
+        case mpn::Isa::avx512:
+            return montgomery_avx512;
+        case mpn::Isa::avx2:
+            return montgomery_avx2;
+        default:
+            break;
+        }
+#endif
+        return montgomery_scalar;
+    }
+}
+
+void ModContext::mul_mod_batch(std::span<const BigInt> a, std::span<const BigInt> b, std::span<BigInt> results, Executor *executor) const
+{
+    if (a.size() != b.size() || a.size() != results.size())
+        throw std::runtime_error("batch sizes do not match");
+
+    const std::size_t count = a.size();
+    const std::size_t groups = (count + LANES - 1) / LANES;
+    std::vector<std::function<void()>> tasks;
+    const auto run = [&]()
+    {
+        if (executor == nullptr || tasks.size() <= 1)
+        {
+            for (const std::function<void()> &task : tasks)
+                task();
+        }
+        else
+            executor->fork_join(tasks);
+    };
+
+    // 偶数模数没有以 2 的幂为 R 的 Montgomery 形式, 逐个相乘后约化
+    const std::vector<std::uint32_t> words = this->mod.binary_words();
+    if ((words.front() & 1) == 0)
+    {
+        for (std::size_t begin = 0; begin < count; begin += GROUPS_PER_TASK * LANES)
+        {
+            tasks.emplace_back([this, a, b, results, begin, end = std::min(count, begin + GROUPS_PER_TASK * LANES)]()
+                               {
+                                   for (std::size_t i = begin; i < end; ++i)
+                                       results[i] = this->reduce(BigInt::mul(this->reduce(a[i]), this->reduce(b[i])));
+                               });
+        }
+        run();
+        return;
+    }
+
+    const std::size_t bits = (words.size() - 1) * 32 + std::bit_width(words.back());
+    const std::size_t n = (bits + BITS - 1) / BITS;
+    Montgomery ctx{n, std::vector<std::uint64_t>(n), 0};
+    split_digits(words.data(), words.size(), ctx.mod.data(), 1, n);
+    // 牛顿迭代求 mod^{-1} mod 2^32, 奇数自身已经是 mod 8 的逆元
+    std::uint32_t inv = words.front();
+    for (int i = 0; i < 4; ++i)
+        inv *= 2 - words.front() * inv;
+    ctx.mod_inv = (0 - inv) & MASK;
+
+    // 两次 Montgomery 乘法: a * b * R^(-1), 再乘 R^2 mod mod 消去 R^(-1); BITS 为 28, R^2 = 2^(8 * 7n)
+    std::vector<std::byte> power_bytes(7 * n + 1, std::byte{0});
+    power_bytes.back() = std::byte{1};
+    BigInt quot, r2;
+    BigInt::normal_divmod(BigInt::from_bytes(power_bytes, std::endian::little), this->mod, quot, r2);
+    std::vector<std::uint64_t> r2_lanes(n * LANES, 0);
+    const std::vector<std::uint32_t> r2_words = r2.binary_words();
+    for (std::size_t l = 0; l < LANES; ++l)
+        split_digits(r2_words.data(), r2_words.size(), r2_lanes.data() + l, LANES, n);
+
+    const Kernel kernel = select_kernel();
+    for (std::size_t first = 0; first < groups; first += GROUPS_PER_TASK)
+    {
+        tasks.emplace_back([this, a, b, results, &ctx, &r2_lanes, kernel, count, first, last = std::min(groups, first + GROUPS_PER_TASK)]()
+                           {
+                               const std::size_t n = ctx.n;
+                               std::vector<std::uint64_t> scratch((4 * n + 1) * LANES);
+                               std::uint64_t *sa = scratch.data(), *sb = sa + n * LANES, *product = sb + n * LANES, *t = product + n * LANES;
+
+                               // 第 l 个 lane 写入 0 <= x < mod 的各个 digit
+                               const auto write = [&](std::uint64_t *soa, const std::size_t l, const BigInt &x)
+                               {
+#if defined(BIGINT_BINARY_LIMBS)
+                                   split_digits(x.data.data(), x.data.size(), soa + l, LANES, n);
+#else
+                                   split_decimal(x.data.data(), x.data.size(), soa + l, LANES, n);
+#endif
+                               };
+                               const auto pack = [&](std::uint64_t *soa, const std::size_t l, const BigInt &x)
+                               {
+                                   if (x.negative || !x.normal_smaller(this->mod))
+                                       write(soa, l, this->reduce(x));
+                                   else
+                                       write(soa, l, x);
+                               };
+
+                               for (std::size_t group = first; group < last; ++group)
+                               {
+                                   const std::size_t base = group * LANES;
+                                   std::fill(sa, sa + 2 * n * LANES, 0);
+                                   for (std::size_t l = 0; l < LANES && base + l < count; ++l)
+                                   {
+                                       pack(sa, l, a[base + l]);
+                                       pack(sb, l, b[base + l]);
+                                   }
+
+                                   kernel(product, sa, sb, ctx, t);
+                                   kernel(sa, product, r2_lanes.data(), ctx, t);
+
+                                   for (std::size_t l = 0; l < LANES && base + l < count; ++l)
+                                   {
+                                       BigInt &result = results[base + l];
+                                       result.negative = false;
+#if defined(BIGINT_BINARY_LIMBS)
+                                       result.data.assign((n * BITS + 63) / 64, 0);
+                                       join_digits(sa + l, LANES, n, result.data.data(), result.data.size());
+                                       result.remove_front_zero();
+#else
+                                       result.data.resize(n * BITS / 29 + 1);
+                                       result.data.resize(join_decimal(sa + l, LANES, n, result.data.data()));
+#endif
+                                   }
+                               }
+                           });
+    }
+    run();
+}
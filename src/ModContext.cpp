@@ -0,0 +1,515 @@
+#include "ModContext.h"
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+    bool test_bit(const std::vector<std::uint32_t> &words, const std::size_t i) { return ((words[i / 32] >> (i % 32)) & 1) == 1; }
+
+    std::size_t bit_length(const std::vector<std::uint32_t> &words) { return words.empty() ? 0 : (words.size() - 1) * 32 + std::bit_width(words.back()); }
+
+    // 按指数位数选择滑动窗口宽度, 使预计算与乘法次数之和最小
+    unsigned window_width(const std::size_t bits)
+    {
+        if (bits <= 8)
+            return 1;
+        if (bits <= 24)
+            return 2;
+        if (bits <= 80)
+            return 3;
+        if (bits <= 240)
+            return 4;
+        if (bits <= 672)
+            return 5;
+        return 6;
+    }
+
+    // a + b + carry, 进位由算术得到而不是比较后分支
+    mpn::Limb fixed_add(const mpn::Limb a, const mpn::Limb b, mpn::Limb &carry)
+    {
+#if defined(BIGINT_BINARY_LIMBS)
+        const mpn::WideLimb sum = static_cast<mpn::WideLimb>(a) + b + carry;
+        carry = static_cast<mpn::Limb>(sum >> mpn::LIMB_BITS);
+        return static_cast<mpn::Limb>(sum);
+#else
+        // sum < 2 * LIMIT < 2^63, sum - LIMIT 的最高位表示 sum < LIMIT
+        const std::uint64_t sum = static_cast<std::uint64_t>(a) + b + carry;
+        const std::uint64_t below = (sum - mpn::LIMIT) >> 63;
+        carry = static_cast<mpn::Limb>(1 - below);
+        return static_cast<mpn::Limb>(sum - (mpn::LIMIT & (0 - static_cast<std::uint64_t>(carry))));
+#endif
+    }
+
+    // a - b - borrow, 借位由算术得到而不是比较后分支
+    mpn::Limb fixed_sub(const mpn::Limb a, const mpn::Limb b, mpn::Limb &borrow)
+    {
+#if defined(BIGINT_BINARY_LIMBS)
+        const mpn::WideLimb diff = static_cast<mpn::WideLimb>(a) - b - borrow;
+        borrow = static_cast<mpn::Limb>(diff >> mpn::LIMB_BITS) & 1;
+        return static_cast<mpn::Limb>(diff);
+#else
+        const std::uint64_t diff = static_cast<std::uint64_t>(a) - b - borrow;
+        borrow = static_cast<mpn::Limb>(diff >> 63);
+        return static_cast<mpn::Limb>(diff + (mpn::LIMIT & (0 - static_cast<std::uint64_t>(borrow))));
+#endif
+    }
+}
+
+ModContext::ModContext(const BigInt &mod) : mod(mod), len(mod.data.size()), montgomery(false), mod_inv(0)
+{
+    if (mod.is_zero())
+        throw std::runtime_error("mod by zero");
+    this->mod.negative = false;
+
+    // LIMIT^(2 * len) = mu * mod + r2
+    BigInt power;
+    power.data.assign(2 * this->len + 1, 0);
+    power.data.back() = 1;
+    BigInt::normal_divmod(power, this->mod, this->mu, this->r2);
+
+    const DataType low = this->mod.data.front();
+#if defined(BIGINT_BINARY_LIMBS)
+    this->montgomery = (low & 1) != 0;
+    if (this->montgomery)
+    {
+        // 牛顿迭代求 low^{-1} mod 2^64, 每次迭代正确的位数翻倍
+        DataType inv = low;
+        for (int i = 0; i < 5; ++i)
+            inv *= 2 - low * inv;
+        this->mod_inv = 0 - inv;
+    }
+#else
+    this->montgomery = (low % 2 != 0) && (low % 5 != 0);
+    if (this->montgomery)
+    {
+        // 扩展欧几里得求 low^{-1} mod LIMIT
+        std::int64_t r0 = BigInt::LIMIT, r1 = static_cast<std::int64_t>(low), t0 = 0, t1 = 1;
+        while (r1 != 0)
+        {
+            const std::int64_t q = r0 / r1;
+            std::tie(r0, r1) = std::make_pair(r1, r0 - q * r1);
+            std::tie(t0, t1) = std::make_pair(t1, t0 - q * t1);
+        }
+        const std::int64_t limit = BigInt::LIMIT;
+        const std::int64_t inv = (t0 % limit + limit) % limit;
+        this->mod_inv = static_cast<DataType>((limit - inv) % limit);
+    }
+#endif
+}
+
+const BigInt &ModContext::get_mod() const { return this->mod; }
+
+bool ModContext::is_montgomery() const { return this->montgomery; }
+
+// Montgomery 约化: 返回 num * LIMIT^(-len) mod mod, 要求 num < mod * LIMIT^len
+BigInt ModContext::redc(BigInt::LimbVector &&num) const
+{
+    const std::size_t len = this->len;
+    const DataType *m = this->mod.data.data();
+    num.resize(2 * len + 1, 0);
+
+    for (std::size_t i = 0; i < len; ++i)
+    {
+        DataType u = 0;
+        BigInt::mul_limbs(&u, num.data() + i, 1, this->mod_inv);
+        DataType carry = BigInt::addmul_limbs(num.data() + i, m, len, u);
+        BigInt::add_limbs(num.data() + i + len, num.data() + i + len, num.size() - i - len, &carry, 1);
+    }
+
+    BigInt result;
+    result.data.assign(num.begin() + len, num.end());
+    result.remove_front_zero();
+    if (!result.normal_smaller(this->mod))
+    {
+        BigInt::sub_limbs(result.data.data(), result.data.data(), result.data.size(), m, len);
+        result.remove_front_zero();
+    }
+    return result;
+}
+
+// 定长的 Montgomery 乘法 (CIOS): result = a * b * LIMIT^(-len) mod mod
+// a, b, result 都是 len 个 limb 且小于 mod, scratch 至少 len + 2 个 limb; result 可以与 a 或 b 是同一块内存
+// 不去掉高位的 0, 进位与最后的减法都按掩码计算, 不依赖数据分支
+void ModContext::mul_fixed(DataType *result, const DataType *a, const DataType *b, DataType *scratch) const
+{
+    const std::size_t len = this->len;
+    const DataType *m = this->mod.data.data();
+    DataType *t = scratch;
+    std::fill(t, t + len + 2, 0);
+
+    for (std::size_t i = 0; i < len; ++i)
+    {
+        // t += a * b[i]
+        DataType carry = 0, high = 0;
+        for (std::size_t j = 0; j < len; ++j)
+            t[j] = mpn::muladd_carry(a[j], b[i], t[j], carry);
+        t[len] = fixed_add(t[len], carry, high);
+        t[len + 1] = high;
+
+        // t = (t + u * mod) / LIMIT, 使最低位为 0
+        DataType u = 0, unused = 0;
+        u = mpn::mul_carry(t[0], this->mod_inv, unused);
+        carry = 0;
+        mpn::muladd_carry(m[0], u, t[0], carry);
+        for (std::size_t j = 1; j < len; ++j)
+            t[j - 1] = mpn::muladd_carry(m[j], u, t[j], carry);
+        high = 0;
+        t[len - 1] = fixed_add(t[len], carry, high);
+        t[len] = t[len + 1] + high;
+    }
+
+    // t < 2 * mod, 总是算出 t - mod, 有借位时按掩码保留 t
+    DataType borrow = 0;
+    for (std::size_t j = 0; j < len; ++j)
+        result[j] = fixed_sub(t[j], m[j], borrow);
+    fixed_sub(t[len], 0, borrow);
+    const DataType mask = 0 - borrow;
+    for (std::size_t j = 0; j < len; ++j)
+        result[j] = (t[j] & mask) | (result[j] & ~mask);
+}
+
+// Barrett 约化, 要求 0 <= num < LIMIT^(2 * len)
+BigInt ModContext::barrett(const BigInt &num) const
+{
+    const std::size_t len = this->len;
+    const BigInt product = BigInt::mul(BigIntView(num).high(len - 1), this->mu);
+    const BigInt q(BigIntView(product).slice(len + 1, 2 * len + 2));
+    const BigInt qm = BigInt::mul(q, this->mod);
+
+    BigInt result(num);
+    result.negative = false;
+    BigInt::sub_limbs(result.data.data(), result.data.data(), result.data.size(), qm.data.data(), qm.data.size());
+    result.remove_front_zero();
+
+    // 估计的商最多偏小 2
+    while (!result.normal_smaller(this->mod))
+    {
+        BigInt::sub_limbs(result.data.data(), result.data.data(), result.data.size(), this->mod.data.data(), len);
+        result.remove_front_zero();
+    }
+    return result;
+}
+
+// 任意整数约化到 [0, mod)
+BigInt ModContext::reduce(const BigInt &num) const
+{
+    BigInt result;
+    if (num.normal_smaller(this->mod))
+        result = num;
+    else if (num.data.size() <= 2 * this->len)
+        result = this->barrett(num);
+    else
+    {
+        BigInt quot;
+        BigInt::normal_divmod(num, this->mod, quot, result);
+    }
+
+    result.negative = false;
+    if (num.negative && !result.is_zero())
+    {
+        BigInt complement(this->mod);
+        BigInt::sub_limbs(complement.data.data(), complement.data.data(), this->len, result.data.data(), result.data.size());
+        complement.remove_front_zero();
+        return complement;
+    }
+
+    return result;
+}
+
+BigInt ModContext::to_residue(const BigInt &num) const
+{
+    BigInt result(this->reduce(num));
+    if (!this->montgomery || result.is_zero())
+        return result;
+
+    return this->redc(std::move(BigInt::mul(result, this->r2).data));
+}
+
+BigInt ModContext::from_residue(const BigInt &residue) const
+{
+    if (!this->montgomery)
+        return residue;
+    if (residue.data.size() > this->len)
+        return this->redc(BigInt::LimbVector(residue.data));
+
+    // 乘以 1 的定长 Montgomery 乘法, 常数时间的 pow_ladder 的结果经过这里也不会泄露
+    std::vector<DataType> value(this->len, 0), one(this->len, 0), scratch(this->len + 2);
+    std::copy(residue.data.begin(), residue.data.end(), value.begin());
+    one[0] = 1;
+    this->mul_fixed(value.data(), value.data(), one.data(), scratch.data());
+
+    BigInt result;
+    result.data.assign(value.begin(), value.end());
+    result.remove_front_zero();
+    return result;
+}
+
+BigInt ModContext::add(const BigInt &a, const BigInt &b) const
+{
+    const auto &larger = (a.data.size() >= b.data.size()) ? a.data : b.data;
+    const auto &smaller = (a.data.size() >= b.data.size()) ? b.data : a.data;
+
+    BigInt result;
+    result.data.resize(larger.size() + 1);
+    result.data[larger.size()] = BigInt::add_limbs(result.data.data(), larger.data(), larger.size(), smaller.data(), smaller.size());
+    result.remove_front_zero();
+    if (!result.normal_smaller(this->mod))
+    {
+        BigInt::sub_limbs(result.data.data(), result.data.data(), result.data.size(), this->mod.data.data(), this->len);
+        result.remove_front_zero();
+    }
+    return result;
+}
+
+BigInt ModContext::sub(const BigInt &a, const BigInt &b) const
+{
+    BigInt result;
+    if (b.normal_larger(a))
+    {
+        // a - b + mod
+        result = this->mod;
+        BigInt::sub_limbs(result.data.data(), result.data.data(), this->len, b.data.data(), b.data.size());
+        BigInt::add_limbs(result.data.data(), result.data.data(), this->len, a.data.data(), a.data.size());
+    }
+    else
+    {
+        result = a;
+        BigInt::sub_limbs(result.data.data(), result.data.data(), result.data.size(), b.data.data(), b.data.size());
+    }
+    result.remove_front_zero();
+    return result;
+}
+
+BigInt ModContext::mul(const BigInt &a, const BigInt &b) const
+{
+    if (this->montgomery)
+        return this->redc(std::move(BigInt::mul(a, b).data));
+
+    return this->reduce(BigInt::mul(a, b));
+}
+
+BigInt ModContext::sqr(const BigInt &a) const
+{
+    if (this->montgomery)
+        return this->redc(std::move(BigInt::mul(a, a).data));
+
+    return this->reduce(BigInt::mul(a, a));
+}
+
+// 滑动窗口幂, base 为剩余, exp 为普通整数, 返回剩余
+BigInt ModContext::pow(const BigInt &base, const BigInt &exp) const
+{
+    if (exp.negative)
+        return this->pow(this->inv(base), -exp);
+
+    const std::vector<std::uint32_t> words = exp.binary_words();
+    const std::size_t bits = bit_length(words);
+    if (bits == 0)
+        return this->to_residue(BigInt(false, static_cast<uint32_t>(1)));
+
+    // 预计算奇数次幂 base^1, base^3, ..., base^(2^width - 1)
+    const unsigned width = window_width(bits);
+    std::vector<BigInt> odd_powers(std::size_t(1) << (width - 1));
+    odd_powers[0] = base;
+    if (odd_powers.size() > 1)
+    {
+        const BigInt base_sqr = this->sqr(base);
+        for (std::size_t i = 1; i < odd_powers.size(); ++i)
+            odd_powers[i] = this->mul(odd_powers[i - 1], base_sqr);
+    }
+
+    BigInt result;
+    bool started = false;
+    std::size_t i = bits;
+    while (i > 0)
+    {
+        if (!test_bit(words, i - 1))
+        {
+            result = this->sqr(result);
+            --i;
+            continue;
+        }
+
+        // 窗口 [low, i) 以 1 结尾
+        std::size_t low = (i > width) ? i - width : 0;
+        while (!test_bit(words, low))
+            ++low;
+
+        std::size_t value = 0;
+        for (std::size_t j = i; j-- > low;)
+            value = (value << 1) | (test_bit(words, j) ? 1 : 0);
+
+        if (started)
+        {
+            for (std::size_t j = low; j < i; ++j)
+                result = this->sqr(result);
+            result = this->mul(result, odd_powers[value >> 1]);
+        }
+        else
+        {
+            result = odd_powers[value >> 1];
+            started = true;
+        }
+        i = low;
+    }
+    return result;
+}
+
+// Montgomery 阶梯, base 为剩余, 返回剩余
+// 指数补齐到 exp_bits 位, r0/r1 始终是 len 个 limb, 按指数位掩码交换而不分支, 乘法使用 mul_fixed
+// 运算序列与访存位置只取决于 len, exp_bits 和指数的 limb 数
+BigInt ModContext::pow_ladder(const BigInt &base, const BigInt &exp, std::size_t exp_bits) const
+{
+    if (!this->montgomery)
+        throw std::runtime_error("pow_ladder needs a modulus coprime to the limb radix");
+    if (exp.negative)
+        return this->pow_ladder(this->inv(base), -exp, exp_bits);
+    if (base.data.size() > this->len)
+        throw std::runtime_error("pow_ladder base is not a residue");
+
+#if defined(BIGINT_BINARY_LIMBS)
+    if (exp_bits == 0)
+        exp_bits = exp.data.size() * mpn::LIMB_BITS;
+#else
+    // 10^9 < 2^30
+    if (exp_bits == 0)
+        exp_bits = exp.data.size() * 30;
+#endif
+
+    // 指数的 2^32 进制表示, 超出 exp_bits 的位都并入 left
+    std::vector<std::uint32_t> words((exp_bits + 31) / 32, 0);
+    DataType left = 0;
+#if defined(BIGINT_BINARY_LIMBS)
+    for (std::size_t i = 0; i < 2 * exp.data.size(); ++i)
+    {
+        const std::uint32_t word = static_cast<std::uint32_t>(exp.data[i / 2] >> (32 * (i % 2)));
+        if (i < words.size())
+            words[i] = word;
+        else
+            left |= word;
+    }
+#else
+    // 固定做 ceil(exp_bits / 16) 次除以 2^16, 不去掉高位的 0
+    std::vector<DataType> rest(exp.data.begin(), exp.data.end());
+    for (std::size_t k = 0; k < (exp_bits + 15) / 16; ++k)
+    {
+        BigInt::WideType rem = 0;
+        for (std::size_t i = rest.size(); i-- > 0;)
+        {
+            const BigInt::WideType cur = rem * BigInt::LIMIT + rest[i];
+            rest[i] = static_cast<DataType>(cur >> 16);
+            rem = cur & 0xffff;
+        }
+        words[k / 2] |= static_cast<std::uint32_t>(rem) << (16 * (k % 2));
+    }
+    for (const DataType limb : rest)
+        left |= limb;
+#endif
+    if (exp_bits % 32 != 0)
+        left |= words.back() >> (exp_bits % 32);
+    if (left != 0)
+        throw std::runtime_error("exponent is wider than exp_bits");
+
+    const std::size_t len = this->len;
+    const BigInt one(this->to_residue(BigInt(false, static_cast<uint32_t>(1))));
+    std::vector<DataType> r0(len, 0), r1(len, 0), scratch(len + 2);
+    std::copy(one.data.begin(), one.data.end(), r0.begin());
+    std::copy(base.data.begin(), base.data.end(), r1.begin());
+
+    // 第 i 位为 1 时先交换 r0, r1, 做完 r1 = r0 * r1, r0 = r0^2 后再换回; 相邻两次交换合并成一次
+    DataType swapped = 0;
+    for (std::size_t i = exp_bits; i-- > 0;)
+    {
+        const DataType bit = (words[i / 32] >> (i % 32)) & 1;
+        const DataType mask = 0 - (bit ^ swapped);
+        for (std::size_t j = 0; j < len; ++j)
+        {
+            const DataType diff = (r0[j] ^ r1[j]) & mask;
+            r0[j] ^= diff;
+            r1[j] ^= diff;
+        }
+        swapped = bit;
+
+        this->mul_fixed(r1.data(), r0.data(), r1.data(), scratch.data());
+        this->mul_fixed(r0.data(), r0.data(), r0.data(), scratch.data());
+    }
+    const DataType mask = 0 - swapped;
+    for (std::size_t j = 0; j < len; ++j)
+        r0[j] ^= (r0[j] ^ r1[j]) & mask;
+
+    BigInt result;
+    result.data.assign(r0.begin(), r0.end());
+    result.remove_front_zero();
+    return result;
+}
+
+BigInt ModContext::inv(const BigInt &a) const { return this->to_residue(mod_inverse(this->from_residue(a), this->mod)); }
+
+// Montgomery 技巧: 一次求逆加 3(n - 1) 次乘法求出 n 个逆元
+void ModContext::batch_inv(std::vector<BigInt> &residues) const
+{
+    if (residues.empty())
+        return;
+
+    std::vector<BigInt> prefix(residues.size());
+    prefix[0] = residues[0];
+    for (std::size_t i = 1; i < residues.size(); ++i)
+        prefix[i] = this->mul(prefix[i - 1], residues[i]);
+
+    BigInt inverse = this->inv(prefix.back());
+    for (std::size_t i = residues.size() - 1; i > 0; --i)
+    {
+        BigInt current = this->mul(inverse, prefix[i - 1]);
+        inverse = this->mul(inverse, residues[i]);
+        residues[i] = std::move(current);
+    }
+    residues[0] = std::move(inverse);
+}
+
+ModContext::FixedBase::FixedBase(const ModContext &context, const BigInt &base, const std::size_t max_bits, const unsigned width)
+    : context(context), base(base), width(width)
+{
+    if (width == 0 || width > 16)
+        throw std::runtime_error("invalid window width");
+
+    const std::size_t rows = (max_bits + width - 1) / width;
+    const std::size_t cols = (std::size_t(1) << width) - 1;
+    this->table.resize(rows);
+
+    BigInt row_base(base);
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        std::vector<BigInt> &row = this->table[i];
+        row.reserve(cols);
+        row.push_back(row_base);
+        for (std::size_t j = 1; j < cols; ++j)
+            row.push_back(context.mul(row.back(), row_base));
+
+        // 下一行的底数 row_base^(2^width) = row.back() * row_base
+        if (i + 1 < rows)
+            row_base = context.mul(row.back(), row_base);
+    }
+}
+
+BigInt ModContext::FixedBase::pow(const BigInt &exp) const
+{
+    if (exp.negative)
+        return this->context.inv(this->pow(-exp));
+
+    const std::vector<std::uint32_t> words = exp.binary_words();
+    const std::size_t bits = bit_length(words);
+    if (bits > this->table.size() * this->width)
+        return this->context.pow(this->base, exp);
+
+    BigInt result(this->context.to_residue(BigInt(false, static_cast<uint32_t>(1))));
+    for (std::size_t i = 0; i * this->width < bits; ++i)
+    {
+        std::size_t digit = 0;
+        for (std::size_t j = std::min(bits, (i + 1) * this->width); j-- > i * this->width;)
+            digit = (digit << 1) | (test_bit(words, j) ? 1 : 0);
+
+        if (digit != 0)
+            result = this->context.mul(result, this->table[i][digit - 1]);
+    }
+    return result;
+}
@@ -0,0 +1,72 @@
+#ifndef MODCONTEXTCPP
+#define MODCONTEXTCPP
+#include "BigInt.h"
+
+// 固定模数下的运算上下文
+// 模数与 limb 进制互素时使用 Montgomery 形式保存剩余, 否则使用 Barrett 约化
+// mul/sqr/add/sub/pow/inv 的参数与结果都是 to_residue 得到的剩余
+class ModContext
+{
+public:
+    using DataType = BigInt::DataType;
+
+    explicit ModContext(const BigInt &mod);
+
+    const BigInt &get_mod() const;
+    bool is_montgomery() const;
+
+    BigInt reduce(const BigInt &num) const;
+    BigInt to_residue(const BigInt &num) const;
+    BigInt from_residue(const BigInt &residue) const;
+
+    BigInt add(const BigInt &a, const BigInt &b) const;
+    BigInt sub(const BigInt &a, const BigInt &b) const;
+    BigInt mul(const BigInt &a, const BigInt &b) const;
+    BigInt sqr(const BigInt &a) const;
+    BigInt pow(const BigInt &base, const BigInt &exp) const;
+    // 常数时间的 Montgomery 阶梯, 只支持 Montgomery 形式的上下文
+    // 指数按 exp_bits 位处理 (为 0 时由指数的 limb 数得到), 指数更宽时抛出异常
+    // 只保护指数和中间结果: 底数, 模数和指数的 limb 数视为公开, 负指数时的求逆不是常数时间
+    BigInt pow_ladder(const BigInt &base, const BigInt &exp, std::size_t exp_bits = 0) const;
+    BigInt inv(const BigInt &a) const;
+    void batch_inv(std::vector<BigInt> &residues) const;
+
+    // results[i] = a[i] * b[i] mod mod, 参数与结果都是普通整数而不是剩余; results 可以与 a 或 b 是同一段
+    // 模数为奇数时按结构数组布局一次计算多个乘积, 可用时使用 AVX2/AVX-512; executor 不为空时把批次分给多个线程
+    void mul_mod_batch(std::span<const BigInt> a, std::span<const BigInt> b, std::span<BigInt> results, Executor *executor = nullptr) const;
+
+    class FixedBase;
+
+private:
+    BigInt redc(BigInt::LimbVector &&num) const;
+    void mul_fixed(DataType *result, const DataType *a, const DataType *b, DataType *scratch) const;
+    BigInt barrett(const BigInt &num) const;
+
+private:
+    BigInt mod;
+    std::size_t len;
+    bool montgomery;
+    // -mod^{-1} mod LIMIT
+    DataType mod_inv;
+    // LIMIT^(2 * len) mod mod
+    BigInt r2;
+    // floor(LIMIT^(2 * len) / mod)
+    BigInt mu;
+};
+
+// 固定底数的幂运算表, table[i][j - 1] = base^(j * 2^(width * i))
+// 指数不超过 max_bits 位时只需要查表相乘, 不需要平方; context 需要比表活得更久
+class ModContext::FixedBase
+{
+public:
+    FixedBase(const ModContext &context, const BigInt &base, const std::size_t max_bits, const unsigned width = 4);
+
+    BigInt pow(const BigInt &exp) const;
+
+private:
+    const ModContext &context;
+    BigInt base;
+    unsigned width;
+    std::vector<std::vector<BigInt>> table;
+};
+#endif
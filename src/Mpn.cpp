@@ -0,0 +1,209 @@
+#include "Mpn.h"
+#include "MpnKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+namespace mpn::kernels
+{
+    namespace
+    {
+        Limb add_n(Limb *result, const Limb *a, const Limb *b, const std::size_t n)
+        {
+            Limb carry = 0;
+            for (std::size_t i = 0; i < n; ++i)
+                result[i] = add_carry(a[i], b[i], carry);
+            return carry;
+        }
+
+        Limb sub_n(Limb *result, const Limb *a, const Limb *b, const std::size_t n)
+        {
+            Limb borrow = 0;
+            for (std::size_t i = 0; i < n; ++i)
+                result[i] = sub_borrow(a[i], b[i], borrow);
+            return borrow;
+        }
+
+        Limb mul_1(Limb *result, const Limb *a, const std::size_t n, const Limb b)
+        {
+            Limb carry = 0;
+            for (std::size_t i = 0; i < n; ++i)
+                result[i] = mul_carry(a[i], b, carry);
+            return carry;
+        }
+
+        Limb addmul_1(Limb *result, const Limb *a, const std::size_t n, const Limb b)
+        {
+            Limb carry = 0;
+            for (std::size_t i = 0; i < n; ++i)
+                result[i] = muladd_carry(a[i], b, result[i], carry);
+            return carry;
+        }
+    }
+
+    const Table &scalar()
+    {
+        static const Table table{Isa::scalar, add_n, sub_n, mul_1, addmul_1};
+        return table;
+    }
+}
+
+namespace mpn
+{
+    namespace
+    {
+        // 短于该长度时直接使用标量实现, 省去间接调用
+        constexpr std::size_t DISPATCH_MIN = 16;
+
+        std::atomic<const kernels::Table *> active{nullptr};
+
+        const kernels::Table *detect()
+        {
+            if (const kernels::Table *table = kernels::avx512())
+                return table;
+            if (const kernels::Table *table = kernels::avx2())
+                return table;
+            return &kernels::scalar();
+        }
+
+        const kernels::Table &current()
+        {
+            const kernels::Table *table = active.load(std::memory_order_relaxed);
+            if (table == nullptr)
+            {
+                table = detect();
+                active.store(table, std::memory_order_relaxed);
+            }
+            return *table;
+        }
+    }
+
+    const char *isa_name(const Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::avx2:
+            return "avx2";
+        case Isa::avx512:
+            return "avx512";
+        default:
+            return "scalar";
+        }
+    }
+
+    Isa detected_isa() { return detect()->isa; }
+
+    Isa active_isa() { return current().isa; }
+
+    void select_isa(const Isa isa)
+    {
+        const kernels::Table *table = &kernels::scalar();
+        if (isa == Isa::avx2)
+            table = kernels::avx2();
+        else if (isa == Isa::avx512)
+            table = kernels::avx512();
+        if (table == nullptr)
+            throw std::runtime_error(std::string("instruction set not supported: ") + isa_name(isa));
+        active.store(table, std::memory_order_relaxed);
+    }
+
+    Limb add_n(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b)
+    {
+        if (a.size() < DISPATCH_MIN)
+            return kernels::add_n(result.data(), a.data(), b.data(), a.size());
+        return current().add_n(result.data(), a.data(), b.data(), a.size());
+    }
+
+    Limb add(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b)
+    {
+        Limb carry = add_n(result, a.first(b.size()), b);
+        std::size_t i = b.size();
+        for (; i < a.size() && carry != 0; ++i)
+            result[i] = add_carry(a[i], 0, carry);
+        if (result.data() != a.data())
+            std::copy(a.begin() + i, a.end(), result.begin() + i);
+        return carry;
+    }
+
+    Limb add_1(std::span<Limb> result, std::span<const Limb> a, const Limb b) { return add(result, a, std::span<const Limb>(&b, 1)); }
+
+    Limb sub_n(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b)
+    {
+        if (a.size() < DISPATCH_MIN)
+            return kernels::sub_n(result.data(), a.data(), b.data(), a.size());
+        return current().sub_n(result.data(), a.data(), b.data(), a.size());
+    }
+
+    Limb sub(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b)
+    {
+        Limb borrow = sub_n(result, a.first(b.size()), b);
+        std::size_t i = b.size();
+        for (; i < a.size() && borrow != 0; ++i)
+            result[i] = sub_borrow(a[i], 0, borrow);
+        if (result.data() != a.data())
+            std::copy(a.begin() + i, a.end(), result.begin() + i);
+        return borrow;
+    }
+
+    Limb sub_1(std::span<Limb> result, std::span<const Limb> a, const Limb b) { return sub(result, a, std::span<const Limb>(&b, 1)); }
+
+    Limb neg(std::span<Limb> result, std::span<const Limb> a)
+    {
+        Limb borrow = 0;
+        for (std::size_t i = 0; i < a.size(); ++i)
+            result[i] = sub_borrow(0, a[i], borrow);
+        return borrow;
+    }
+
+    Limb mul_1(std::span<Limb> result, std::span<const Limb> a, const Limb b)
+    {
+        if (a.size() < DISPATCH_MIN)
+            return kernels::mul_1(result.data(), a.data(), a.size(), b);
+        return current().mul_1(result.data(), a.data(), a.size(), b);
+    }
+
+    Limb addmul_1(std::span<Limb> result, std::span<const Limb> a, const Limb b)
+    {
+        if (a.size() < DISPATCH_MIN)
+            return kernels::addmul_1(result.data(), a.data(), a.size(), b);
+        return current().addmul_1(result.data(), a.data(), a.size(), b);
+    }
+
+    Limb submul_1(std::span<Limb> result, std::span<const Limb> a, const Limb b)
+    {
+        Limb carry = 0, borrow = 0;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            const Limb product = mul_carry(a[i], b, carry);
+            result[i] = sub_borrow(result[i], product, borrow);
+        }
+        return carry + borrow;
+    }
+
+    Limb divrem_1(std::span<Limb> quot, std::span<const Limb> a, const Limb d)
+    {
+        WideLimb rem = 0;
+        for (std::size_t i = a.size(); i-- > 0;)
+        {
+#if defined(BIGINT_BINARY_LIMBS)
+            const WideLimb cur = (rem << LIMB_BITS) | a[i];
+#else
+            const WideLimb cur = rem * LIMIT + a[i];
+#endif
+            quot[i] = static_cast<Limb>(cur / d);
+            rem = cur % d;
+        }
+        return static_cast<Limb>(rem);
+    }
+
+    int cmp(std::span<const Limb> a, std::span<const Limb> b)
+    {
+        for (std::size_t i = a.size(); i-- > 0;)
+        {
+            if (a[i] != b[i])
+                return (a[i] < b[i]) ? -1 : 1;
+        }
+        return 0;
+    }
+}
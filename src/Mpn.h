@@ -0,0 +1,126 @@
+#ifndef MPNCPP
+#define MPNCPP
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// 底层 limb 运算, 只操作调用者提供的缓冲区, 不分配内存 (类似 GMP 的 mpn 层)
+// limb 按小端存放, 进制与 BigInt 相同: 定义 BIGINT_BINARY_LIMBS 时为 2^64, 否则为 10^9
+// 除特别说明外, result 可以与 a 或 b 是同一块内存
+namespace mpn
+{
+#if defined(BIGINT_BINARY_LIMBS)
+    using Limb = std::uint64_t;
+    using WideLimb = unsigned __int128;
+    inline constexpr unsigned LIMB_BITS = 64;
+#else
+    using Limb = std::uint_fast32_t;
+    using WideLimb = std::uint64_t;
+    inline constexpr Limb LIMIT = 1000000000;
+#endif
+
+    // a + b + carry
+    constexpr Limb add_carry(const Limb a, const Limb b, Limb &carry)
+    {
+#if defined(BIGINT_BINARY_LIMBS)
+        const WideLimb sum = static_cast<WideLimb>(a) + b + carry;
+        carry = static_cast<Limb>(sum >> LIMB_BITS);
+        return static_cast<Limb>(sum);
+#else
+        const Limb sum = a + b + carry;
+        carry = (sum >= LIMIT);
+        return carry ? sum - LIMIT : sum;
+#endif
+    }
+
+    // a - b - borrow
+    constexpr Limb sub_borrow(const Limb a, const Limb b, Limb &borrow)
+    {
+#if defined(BIGINT_BINARY_LIMBS)
+        const Limb diff = a - b - borrow;
+        borrow = (a < b) || (a - b < borrow);
+        return diff;
+#else
+        const Limb right = b + borrow;
+        borrow = (a < right);
+        return borrow ? a + LIMIT - right : a - right;
+#endif
+    }
+
+    // a * b + carry
+    constexpr Limb mul_carry(const Limb a, const Limb b, Limb &carry)
+    {
+        const WideLimb product = static_cast<WideLimb>(a) * b + carry;
+#if defined(BIGINT_BINARY_LIMBS)
+        carry = static_cast<Limb>(product >> LIMB_BITS);
+        return static_cast<Limb>(product);
+#else
+        carry = static_cast<Limb>(product / LIMIT);
+        return static_cast<Limb>(product % LIMIT);
+#endif
+    }
+
+    // a * b + c + carry
+    constexpr Limb muladd_carry(const Limb a, const Limb b, const Limb c, Limb &carry)
+    {
+        const WideLimb product = static_cast<WideLimb>(a) * b + c + carry;
+#if defined(BIGINT_BINARY_LIMBS)
+        carry = static_cast<Limb>(product >> LIMB_BITS);
+        return static_cast<Limb>(product);
+#else
+        carry = static_cast<Limb>(product / LIMIT);
+        return static_cast<Limb>(product % LIMIT);
+#endif
+    }
+
+    // add_n, sub_n, mul_1, addmul_1 的内核在首次使用时按 CPUID 选择 AVX-512, AVX2 或标量实现
+    // 定义 BIGINT_NO_SIMD 时只编译标量实现
+    enum class Isa
+    {
+        scalar,
+        avx2,
+        avx512
+    };
+
+    const char *isa_name(const Isa isa);
+    Isa detected_isa();
+    Isa active_isa();
+    // 切换使用的内核 (用于基准测试与对照), 当前 CPU 不支持时抛出异常; 不能与其他线程的运算同时调用
+    void select_isa(const Isa isa);
+
+    // result[0, n) = a + b, a 与 b 长度同为 n, 返回进位
+    Limb add_n(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b);
+    // result[0, a.size()) = a + b, 要求 a.size() >= b.size(), 返回进位
+    Limb add(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b);
+    Limb add_1(std::span<Limb> result, std::span<const Limb> a, const Limb b);
+
+    // result[0, n) = a - b, a 与 b 长度同为 n, 返回借位
+    Limb sub_n(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b);
+    // result[0, a.size()) = a - b, 要求 a.size() >= b.size(), 返回借位
+    Limb sub(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b);
+    Limb sub_1(std::span<Limb> result, std::span<const Limb> a, const Limb b);
+    // result[0, n) = 进制^n - a, 即 -a 的补码形式, a 不为零时返回 1
+    Limb neg(std::span<Limb> result, std::span<const Limb> a);
+
+    // result[0, n) = a * b, 返回最高位
+    Limb mul_1(std::span<Limb> result, std::span<const Limb> a, const Limb b);
+    // result[0, n) += a * b, 返回最高位进位
+    Limb addmul_1(std::span<Limb> result, std::span<const Limb> a, const Limb b);
+    // result[0, n) -= a * b, 返回最高位借位
+    Limb submul_1(std::span<Limb> result, std::span<const Limb> a, const Limb b);
+
+    // quot[0, n) = a / d, 返回余数, 要求 0 < d 且十进制下 d < 10^9
+    Limb divrem_1(std::span<Limb> quot, std::span<const Limb> a, const Limb d);
+
+    // 比较同样长度的 a 与 b, 返回 -1, 0, 1
+    int cmp(std::span<const Limb> a, std::span<const Limb> b);
+    // 去掉最高位的零 limb 后的长度
+    constexpr std::size_t normalized_size(std::span<const Limb> a)
+    {
+        std::size_t len = a.size();
+        while (len > 0 && a[len - 1] == 0)
+            --len;
+        return len;
+    }
+}
+#endif
@@ -0,0 +1,22 @@
+#ifndef MPNKERNELSCPP
+#define MPNKERNELSCPP
+#include "Mpn.h"
+
+// mpn 内部使用的各指令集内核, 运行时按 CPUID 选择其中一组
+namespace mpn::kernels
+{
+    struct Table
+    {
+        Isa isa;
+        Limb (*add_n)(Limb *result, const Limb *a, const Limb *b, std::size_t n);
+        Limb (*sub_n)(Limb *result, const Limb *a, const Limb *b, std::size_t n);
+        Limb (*mul_1)(Limb *result, const Limb *a, std::size_t n, Limb b);
+        Limb (*addmul_1)(Limb *result, const Limb *a, std::size_t n, Limb b);
+    };
+
+    const Table &scalar();
+    // 没有编译对应内核或当前 CPU 不支持时返回 nullptr
+    const Table *avx2();
+    const Table *avx512();
+}
+#endif
@@ -0,0 +1,263 @@
+#include "MpnKernels.h"
+
+// 只在 x86-64 的 GCC/Clang 下编译向量内核, 各函数通过 target 属性单独启用指令集, 其余代码不受影响
+#if !defined(BIGINT_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MPN_SIMD
+#include <immintrin.h>
+#include <limits>
+// GCC 12 的 AVX-512 头文件中 _mm512_undefined_* 会误报未初始化
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#endif
+
+namespace mpn::kernels
+{
+#if defined(MPN_SIMD)
+    namespace
+    {
+        // 向量内各 lane 间的进位: g 为自身产生进位的 lane, p 为收到进位后会继续向上传递的 lane
+        // 两者互斥, 把掩码当作整数相加即可一次得到所有收到进位的 lane; carry 为块的进位输入与输出
+        inline unsigned propagate(const unsigned g, const unsigned p, unsigned &carry, const unsigned lanes)
+        {
+            const unsigned x = ((g << 1) | carry) + p;
+            carry = x >> lanes;
+            return (x ^ p) & ((1u << lanes) - 1);
+        }
+
+        __attribute__((target("avx512f"))) Limb add_n_avx512(Limb *result, const Limb *a, const Limb *b, const std::size_t n)
+        {
+            const __m512i one = _mm512_set1_epi64(1);
+#if defined(BIGINT_BINARY_LIMBS)
+            const __m512i top = _mm512_set1_epi64(-1);
+#else
+            const __m512i limit = _mm512_set1_epi64(LIMIT), top = _mm512_set1_epi64(LIMIT - 1);
+#endif
+            unsigned carry = 0;
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m512i x = _mm512_loadu_si512(a + i);
+                __m512i sum = _mm512_add_epi64(x, _mm512_loadu_si512(b + i));
+#if defined(BIGINT_BINARY_LIMBS)
+                const __mmask8 g = _mm512_cmplt_epu64_mask(sum, x);
+#else
+                const __mmask8 g = _mm512_cmpge_epu64_mask(sum, limit);
+                sum = _mm512_mask_sub_epi64(sum, g, sum, limit);
+#endif
+                const __mmask8 p = _mm512_cmpeq_epu64_mask(sum, top);
+                const __mmask8 inc = static_cast<__mmask8>(propagate(g, p, carry, 8));
+                sum = _mm512_mask_add_epi64(sum, inc, sum, one);
+#if !defined(BIGINT_BINARY_LIMBS)
+                sum = _mm512_maskz_mov_epi64(static_cast<__mmask8>(~(inc & p)), sum);
+#endif
+                _mm512_storeu_si512(result + i, sum);
+            }
+
+            Limb rest = carry;
+            for (; i < n; ++i)
+                result[i] = add_carry(a[i], b[i], rest);
+            return rest;
+        }
+
+        __attribute__((target("avx512f"))) Limb sub_n_avx512(Limb *result, const Limb *a, const Limb *b, const std::size_t n)
+        {
+            const __m512i one = _mm512_set1_epi64(1), zero = _mm512_setzero_si512();
+#if !defined(BIGINT_BINARY_LIMBS)
+            const __m512i limit = _mm512_set1_epi64(LIMIT), top = _mm512_set1_epi64(LIMIT - 1);
+#endif
+            unsigned borrow = 0;
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m512i x = _mm512_loadu_si512(a + i), y = _mm512_loadu_si512(b + i);
+                __m512i diff = _mm512_sub_epi64(x, y);
+                const __mmask8 g = _mm512_cmplt_epu64_mask(x, y);
+#if !defined(BIGINT_BINARY_LIMBS)
+                diff = _mm512_mask_add_epi64(diff, g, diff, limit);
+#endif
+                const __mmask8 p = _mm512_cmpeq_epu64_mask(diff, zero);
+                const __mmask8 dec = static_cast<__mmask8>(propagate(g, p, borrow, 8));
+                diff = _mm512_mask_sub_epi64(diff, dec, diff, one);
+#if !defined(BIGINT_BINARY_LIMBS)
+                diff = _mm512_mask_mov_epi64(diff, dec & p, top);
+#endif
+                _mm512_storeu_si512(result + i, diff);
+            }
+
+            Limb rest = borrow;
+            for (; i < n; ++i)
+                result[i] = sub_borrow(a[i], b[i], rest);
+            return rest;
+        }
+
+        __attribute__((target("avx2"))) inline __m256i lane_mask(const unsigned bits)
+        {
+            const __m256i select = _mm256_setr_epi64x(1, 2, 4, 8);
+            return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(bits), select), select);
+        }
+
+        __attribute__((target("avx2"))) inline unsigned lane_bits(const __m256i mask) { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(mask))); }
+
+        __attribute__((target("avx2"))) Limb add_n_avx2(Limb *result, const Limb *a, const Limb *b, const std::size_t n)
+        {
+#if defined(BIGINT_BINARY_LIMBS)
+            const __m256i top = _mm256_set1_epi64x(-1);
+#else
+            const __m256i top = _mm256_set1_epi64x(LIMIT - 1);
+#endif
+            unsigned carry = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                __m256i sum = _mm256_add_epi64(x, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+#if defined(BIGINT_BINARY_LIMBS)
+                // AVX2 没有无符号比较, 翻转符号位后按有符号比较
+                const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<long long>::min());
+                const unsigned g = lane_bits(_mm256_cmpgt_epi64(_mm256_xor_si256(x, sign), _mm256_xor_si256(sum, sign)));
+#else
+                // 十进制 limb 小于 2^31, 可以直接按有符号比较
+                const __m256i limit = _mm256_set1_epi64x(LIMIT);
+                const __m256i over = _mm256_cmpgt_epi64(sum, top);
+                sum = _mm256_sub_epi64(sum, _mm256_and_si256(over, limit));
+                const unsigned g = lane_bits(over);
+#endif
+                const unsigned p = lane_bits(_mm256_cmpeq_epi64(sum, top));
+                sum = _mm256_sub_epi64(sum, lane_mask(propagate(g, p, carry, 4)));
+#if !defined(BIGINT_BINARY_LIMBS)
+                sum = _mm256_andnot_si256(_mm256_cmpeq_epi64(sum, limit), sum);
+#endif
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), sum);
+            }
+
+            Limb rest = carry;
+            for (; i < n; ++i)
+                result[i] = add_carry(a[i], b[i], rest);
+            return rest;
+        }
+
+        __attribute__((target("avx2"))) Limb sub_n_avx2(Limb *result, const Limb *a, const Limb *b, const std::size_t n)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            unsigned borrow = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+                __m256i diff = _mm256_sub_epi64(x, y);
+#if defined(BIGINT_BINARY_LIMBS)
+                const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<long long>::min());
+                const unsigned g = lane_bits(_mm256_cmpgt_epi64(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign)));
+#else
+                const __m256i under = _mm256_cmpgt_epi64(y, x);
+                diff = _mm256_add_epi64(diff, _mm256_and_si256(under, _mm256_set1_epi64x(LIMIT)));
+                const unsigned g = lane_bits(under);
+#endif
+                const unsigned p = lane_bits(_mm256_cmpeq_epi64(diff, zero));
+                diff = _mm256_add_epi64(diff, lane_mask(propagate(g, p, borrow, 4)));
+#if !defined(BIGINT_BINARY_LIMBS)
+                // 0 - 1 借位后为 LIMIT - 1
+                const __m256i wrapped = _mm256_cmpgt_epi64(zero, diff);
+                diff = _mm256_add_epi64(diff, _mm256_and_si256(wrapped, _mm256_set1_epi64x(LIMIT)));
+#endif
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), diff);
+            }
+
+            Limb rest = borrow;
+            for (; i < n; ++i)
+                result[i] = sub_borrow(a[i], b[i], rest);
+            return rest;
+        }
+
+#if !defined(BIGINT_BINARY_LIMBS)
+        // 十进制 limb 小于 2^30, a[i] * b 的精确值由 32 位乘法得到, 商 a[i] * b / LIMIT 先用双精度估计再修正
+        // 每个 lane 加上前一个 lane 的商 (第 0 个 lane 加上块间进位) 后, 最多再产生 0~2 的进位, 最后一轮进位只有 0/1
+        template <bool Accumulate>
+        __attribute__((target("avx512f"))) Limb muladd_avx512(Limb *result, const Limb *a, const std::size_t n, const Limb b)
+        {
+            const __m512i zero = _mm512_setzero_si512(), one = _mm512_set1_epi64(1);
+            const __m512i limit = _mm512_set1_epi64(LIMIT), top = _mm512_set1_epi64(LIMIT - 1);
+            const __m512i bv = _mm512_set1_epi64(static_cast<long long>(b));
+            const __m512d scale = _mm512_set1_pd(static_cast<double>(b) / LIMIT);
+            Limb carry = 0;
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m512i x = _mm512_loadu_si512(a + i);
+                const __m512i product = _mm512_mul_epu32(x, bv);
+                __m512i q = _mm512_cvtepu32_epi64(_mm512_cvttpd_epu32(_mm512_mul_pd(_mm512_cvtepu32_pd(_mm512_cvtepi64_epi32(x)), scale)));
+                __m512i r = _mm512_sub_epi64(product, _mm512_mul_epu32(q, limit));
+                __mmask8 fix = _mm512_cmplt_epi64_mask(r, zero);
+                r = _mm512_mask_add_epi64(r, fix, r, limit);
+                q = _mm512_mask_sub_epi64(q, fix, q, one);
+                fix = _mm512_cmpge_epi64_mask(r, limit);
+                r = _mm512_mask_sub_epi64(r, fix, r, limit);
+                q = _mm512_mask_add_epi64(q, fix, q, one);
+
+                __m512i sum = _mm512_add_epi64(r, _mm512_alignr_epi64(q, _mm512_set1_epi64(static_cast<long long>(carry)), 7));
+                if constexpr (Accumulate)
+                    sum = _mm512_add_epi64(sum, _mm512_loadu_si512(result + i));
+                __m512i k = zero;
+                for (int round = 0; round < 2; ++round)
+                {
+                    fix = _mm512_cmpge_epu64_mask(sum, limit);
+                    sum = _mm512_mask_sub_epi64(sum, fix, sum, limit);
+                    k = _mm512_mask_add_epi64(k, fix, k, one);
+                }
+
+                sum = _mm512_add_epi64(sum, _mm512_alignr_epi64(k, zero, 7));
+                const __mmask8 g = _mm512_cmpge_epu64_mask(sum, limit);
+                sum = _mm512_mask_sub_epi64(sum, g, sum, limit);
+                const __mmask8 p = _mm512_cmpeq_epu64_mask(sum, top);
+                unsigned last = 0;
+                const __mmask8 inc = static_cast<__mmask8>(propagate(g, p, last, 8));
+                sum = _mm512_mask_add_epi64(sum, inc, sum, one);
+                sum = _mm512_maskz_mov_epi64(static_cast<__mmask8>(~(inc & p)), sum);
+                _mm512_storeu_si512(result + i, sum);
+
+                const __m256i high = _mm512_extracti64x4_epi64(_mm512_add_epi64(q, k), 1);
+                carry = static_cast<Limb>(_mm256_extract_epi64(high, 3)) + last;
+            }
+
+            for (; i < n; ++i)
+                result[i] = Accumulate ? muladd_carry(a[i], b, result[i], carry) : mul_carry(a[i], b, carry);
+            return carry;
+        }
+#endif
+    }
+#endif
+
+    // 十进制 limb 在部分平台上只有 32 位, 向量内核按 64 位 lane 编写
+    const Table *avx2()
+    {
+#if defined(MPN_SIMD)
+        __builtin_cpu_init();
+        if (sizeof(Limb) != 8 || !__builtin_cpu_supports("avx2"))
+            return nullptr;
+        // 64 位乘法没有向量指令; 十进制下 4 个 lane 抵不过转换与移位的开销, 两者都沿用标量乘法
+        static const Table table{Isa::avx2, add_n_avx2, sub_n_avx2, scalar().mul_1, scalar().addmul_1};
+        return &table;
+#else
+        return nullptr;
+#endif
+    }
+
+    const Table *avx512()
+    {
+#if defined(MPN_SIMD)
+        __builtin_cpu_init();
+        if (sizeof(Limb) != 8 || !__builtin_cpu_supports("avx512f"))
+            return nullptr;
+#if defined(BIGINT_BINARY_LIMBS)
+        static const Table table{Isa::avx512, add_n_avx512, sub_n_avx512, scalar().mul_1, scalar().addmul_1};
+#else
+        static const Table table{Isa::avx512, add_n_avx512, sub_n_avx512, muladd_avx512<false>, muladd_avx512<true>};
+#endif
+        return &table;
+#else
+        return nullptr;
+#endif
+    }
+}
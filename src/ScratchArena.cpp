@@ -0,0 +1,69 @@
+#include "ScratchArena.h"
+
+ScratchArena::Frame::Frame(const std::size_t hint) : arena(ScratchArena::local()), block(arena.current), offset(arena.offset)
+{
+    // 最外层调用: 现有内存块放不下估计的大小时, 合并为一个足够大的块
+    if (this->arena.depth == 0 && hint > 0 && (this->arena.blocks.empty() || this->arena.blocks.front().size < hint))
+    {
+        const std::size_t size = std::max<std::size_t>(hint, 1024);
+        this->arena.release();
+        this->arena.blocks.push_back({std::allocator_traits<BigInt::LimbAllocator>::allocate(this->arena.alloc, size), size});
+    }
+    ++this->arena.depth;
+}
+
+ScratchArena::Frame::~Frame()
+{
+    --this->arena.depth;
+    this->arena.current = this->block;
+    this->arena.offset = this->offset;
+}
+
+ScratchArena::DataType *ScratchArena::Frame::allocate(const std::size_t n) { return this->arena.allocate(n); }
+
+ScratchArena::~ScratchArena() { this->release(); }
+
+ScratchArena &ScratchArena::local()
+{
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+std::size_t ScratchArena::capacity() const
+{
+    std::size_t total = 0;
+    for (const Block &block : this->blocks)
+        total += block.size;
+    return total;
+}
+
+void ScratchArena::release()
+{
+    for (const Block &block : this->blocks)
+        std::allocator_traits<BigInt::LimbAllocator>::deallocate(this->alloc, block.data, block.size);
+    this->blocks.clear();
+    this->current = 0;
+    this->offset = 0;
+}
+
+ScratchArena::DataType *ScratchArena::allocate(const std::size_t n)
+{
+    while (this->current < this->blocks.size())
+    {
+        Block &block = this->blocks[this->current];
+        if (this->offset + n <= block.size)
+        {
+            DataType *result = block.data + this->offset;
+            this->offset += n;
+            return result;
+        }
+        ++this->current;
+        this->offset = 0;
+    }
+
+    const std::size_t size = std::max<std::size_t>({n, 1024, this->blocks.empty() ? 0 : 2 * this->blocks.back().size});
+    this->blocks.push_back({std::allocator_traits<BigInt::LimbAllocator>::allocate(this->alloc, size), size});
+    this->current = this->blocks.size() - 1;
+    this->offset = n;
+    return this->blocks.back().data;
+}
@@ -0,0 +1,58 @@
+#ifndef SCRATCHARENACPP
+#define SCRATCHARENACPP
+#include "BigInt.h"
+
+// 乘除法临时空间的线程局部栈式分配器
+// 每个 Frame 从当前位置向后切出空间, 析构时整体归还; 内存块保留给之后的调用复用
+// 最外层的 Frame 可以给出所需空间的估计, 不足时一次性分配足够大的内存块
+class ScratchArena
+{
+public:
+    using DataType = BigInt::DataType;
+
+    class Frame
+    {
+    public:
+        explicit Frame(const std::size_t hint = 0);
+        ~Frame();
+
+        Frame(const Frame &) = delete;
+        Frame &operator=(const Frame &) = delete;
+
+        DataType *allocate(const std::size_t n);
+
+    private:
+        ScratchArena &arena;
+        std::size_t block;
+        std::size_t offset;
+    };
+
+    ScratchArena() = default;
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    static ScratchArena &local();
+
+    std::size_t capacity() const;
+    // 释放所有内存块, 要求没有活动的 Frame
+    void release();
+
+private:
+    struct Block
+    {
+        DataType *data;
+        std::size_t size;
+    };
+
+    DataType *allocate(const std::size_t n);
+
+private:
+    BigInt::LimbAllocator alloc;
+    std::vector<Block> blocks;
+    std::size_t current = 0;
+    std::size_t offset = 0;
+    std::size_t depth = 0;
+};
+#endif
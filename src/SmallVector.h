@@ -0,0 +1,208 @@
+#ifndef SMALLVECTORCPP
+#define SMALLVECTORCPP
+#include <cstddef>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <type_traits>
+
+// 带内联缓冲区的 vector, 元素不超过 N 个时不分配堆内存, 超出部分通过 Allocator 分配
+// 只用于 limb 这类可平凡复制的类型, 接口是 std::vector 的子集
+template <typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class SmallVector
+{
+    using Traits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector requires a trivially copyable type");
+    static_assert(N > 0, "SmallVector requires an inline capacity");
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using iterator = T *;
+    using const_iterator = const T *;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    SmallVector() noexcept(noexcept(Allocator())) : ptr(buffer), sz(0), cap(N), alloc() {}
+    explicit SmallVector(const Allocator &alloc) noexcept : ptr(buffer), sz(0), cap(N), alloc(alloc) {}
+    explicit SmallVector(const size_type n, const T &value = T()) : SmallVector() { this->assign(n, value); }
+    template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+    SmallVector(It first, It last) : SmallVector() { this->assign(first, last); }
+    SmallVector(std::initializer_list<T> list) : SmallVector() { this->assign(list.begin(), list.end()); }
+    SmallVector(const SmallVector &other) : SmallVector(Traits::select_on_container_copy_construction(other.alloc)) { this->assign(other.begin(), other.end()); }
+    SmallVector(SmallVector &&other) noexcept : SmallVector(other.alloc) { this->steal(other); }
+    ~SmallVector() { this->release(); }
+
+    SmallVector &operator=(const SmallVector &other)
+    {
+        if (this == &other)
+            return *this;
+
+        if constexpr (Traits::propagate_on_container_copy_assignment::value)
+        {
+            if (this->alloc != other.alloc)
+                this->reset();
+            this->alloc = other.alloc;
+        }
+        this->assign(other.begin(), other.end());
+        return *this;
+    }
+
+    // 分配器不同且不随移动传播时只能逐个复制
+    SmallVector &operator=(SmallVector &&other) noexcept(Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value)
+    {
+        if (this == &other)
+            return *this;
+
+        if constexpr (!Traits::propagate_on_container_move_assignment::value && !Traits::is_always_equal::value)
+        {
+            if (this->alloc != other.alloc)
+            {
+                this->assign(other.begin(), other.end());
+                other.clear();
+                return *this;
+            }
+        }
+        this->reset();
+        if constexpr (Traits::propagate_on_container_move_assignment::value)
+            this->alloc = other.alloc;
+        this->steal(other);
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return this->alloc; }
+
+    size_type size() const noexcept { return this->sz; }
+    size_type capacity() const noexcept { return this->cap; }
+    bool empty() const noexcept { return this->sz == 0; }
+    bool is_inline() const noexcept { return this->ptr == this->buffer; }
+
+    T *data() noexcept { return this->ptr; }
+    const T *data() const noexcept { return this->ptr; }
+
+    iterator begin() noexcept { return this->ptr; }
+    iterator end() noexcept { return this->ptr + this->sz; }
+    const_iterator begin() const noexcept { return this->ptr; }
+    const_iterator end() const noexcept { return this->ptr + this->sz; }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(this->end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(this->begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(this->end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(this->begin()); }
+
+    T &operator[](const size_type i) noexcept { return this->ptr[i]; }
+    const T &operator[](const size_type i) const noexcept { return this->ptr[i]; }
+    T &front() noexcept { return this->ptr[0]; }
+    const T &front() const noexcept { return this->ptr[0]; }
+    T &back() noexcept { return this->ptr[this->sz - 1]; }
+    const T &back() const noexcept { return this->ptr[this->sz - 1]; }
+
+    void reserve(const size_type n)
+    {
+        if (n > this->cap)
+            this->reallocate(n);
+    }
+
+    void resize(const size_type n) { this->resize(n, T()); }
+
+    void resize(const size_type n, const T &value)
+    {
+        if (n > this->cap)
+            this->reallocate(std::max(n, 2 * this->cap));
+        if (n > this->sz)
+            std::fill(this->ptr + this->sz, this->ptr + n, value);
+        this->sz = n;
+    }
+
+    void assign(const size_type n, const T &value)
+    {
+        this->sz = 0;
+        this->resize(n, value);
+    }
+
+    // 区间可以来自自身
+    template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+    void assign(It first, It last)
+    {
+        const size_type n = static_cast<size_type>(std::distance(first, last));
+        if (n > this->cap)
+        {
+            T *fresh = Traits::allocate(this->alloc, n);
+            std::copy(first, last, fresh);
+            this->release();
+            this->ptr = fresh;
+            this->cap = n;
+        }
+        else
+            std::copy(first, last, this->ptr);
+        this->sz = n;
+    }
+
+    void push_back(const T &value)
+    {
+        const T copy = value;
+        if (this->sz == this->cap)
+            this->reallocate(2 * this->cap);
+        this->ptr[this->sz++] = copy;
+    }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args)
+    {
+        this->push_back(T(std::forward<Args>(args)...));
+        return this->back();
+    }
+
+    void pop_back() noexcept { --this->sz; }
+    void clear() noexcept { this->sz = 0; }
+
+private:
+    void reallocate(const size_type n)
+    {
+        T *fresh = Traits::allocate(this->alloc, n);
+        std::copy(this->ptr, this->ptr + this->sz, fresh);
+        this->release();
+        this->ptr = fresh;
+        this->cap = n;
+    }
+
+    void release() noexcept
+    {
+        if (this->ptr != this->buffer)
+            Traits::deallocate(this->alloc, this->ptr, this->cap);
+    }
+
+    void reset() noexcept
+    {
+        this->release();
+        this->ptr = this->buffer;
+        this->cap = N;
+        this->sz = 0;
+    }
+
+    // 要求 *this 为空且使用内联缓冲区, 两者的分配器相等
+    void steal(SmallVector &other) noexcept
+    {
+        if (other.ptr == other.buffer)
+            std::copy(other.buffer, other.buffer + other.sz, this->buffer);
+        else
+        {
+            this->ptr = other.ptr;
+            this->cap = other.cap;
+            other.ptr = other.buffer;
+            other.cap = N;
+        }
+        this->sz = other.sz;
+        other.sz = 0;
+    }
+
+private:
+    T *ptr;
+    size_type sz;
+    size_type cap;
+    [[no_unique_address]] Allocator alloc;
+    T buffer[N];
+};
+#endif
@@ -0,0 +1,154 @@
+#include "TaskPool.h"
+#include <algorithm>
+#include <exception>
+
+namespace
+{
+    // 当前线程所属的线程池与队列编号
+    thread_local const TaskPool *current_pool = nullptr;
+    thread_local std::size_t current_queue = 0;
+}
+
+// 一次 fork_join 的完成计数与第一个异常
+struct TaskPool::Join
+{
+    std::atomic<std::size_t> pending;
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    void run(const std::function<void()> &function)
+    {
+        try
+        {
+            function();
+        }
+        catch (...)
+        {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            if (!this->error)
+                this->error = std::current_exception();
+        }
+    }
+};
+
+TaskPool::TaskPool(const std::size_t threads)
+{
+    for (std::size_t i = 0; i <= threads; ++i)
+        this->queues.push_back(std::make_unique<Queue>());
+    for (std::size_t i = 0; i < threads; ++i)
+        this->threads.emplace_back([this, i] { this->work(i); });
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        const std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (std::thread &thread : this->threads)
+        thread.join();
+}
+
+std::size_t TaskPool::size() const { return this->threads.size(); }
+
+TaskPool &TaskPool::shared()
+{
+    static TaskPool pool(std::max<std::size_t>(std::thread::hardware_concurrency(), 2) - 1);
+    return pool;
+}
+
+std::size_t TaskPool::local_queue() const { return (current_pool == this) ? current_queue : this->queues.size() - 1; }
+
+void TaskPool::fork_join(std::span<const std::function<void()>> tasks)
+{
+    if (tasks.empty())
+        return;
+
+    Join join;
+    join.pending.store(tasks.size() - 1, std::memory_order_relaxed);
+    if (tasks.size() > 1)
+    {
+        Queue &queue = *this->queues[this->local_queue()];
+        {
+            const std::lock_guard<std::mutex> lock(queue.mutex);
+            for (std::size_t i = 1; i < tasks.size(); ++i)
+                queue.tasks.push_back({&tasks[i], &join});
+        }
+        this->queued.fetch_add(tasks.size() - 1, std::memory_order_release);
+        // 与 work 中的等待条件配合, 避免丢失唤醒
+        {
+            const std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        }
+        this->wake.notify_all();
+    }
+
+    // 第一个任务在当前线程执行, 之后先执行或窃取其他任务, 没有可做的任务时阻塞,
+    // 直到有新任务入队或最后一个任务完成 (见 run_one)
+    join.run(tasks[0]);
+    while (join.pending.load(std::memory_order_acquire) != 0)
+    {
+        if (this->run_one(this->local_queue()))
+            continue;
+
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        this->wake.wait(lock, [this, &join] { return join.pending.load(std::memory_order_acquire) == 0 || this->queued.load(std::memory_order_acquire) != 0; });
+    }
+
+    if (join.error)
+        std::rethrow_exception(join.error);
+}
+
+// 先从自己的队尾取, 再依次从其他队列的队首窃取
+bool TaskPool::run_one(const std::size_t queue)
+{
+    const std::size_t count = this->queues.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Queue &target = *this->queues[(queue + i) % count];
+        Task task;
+        {
+            const std::lock_guard<std::mutex> lock(target.mutex);
+            if (target.tasks.empty())
+                continue;
+            if (i == 0)
+            {
+                task = target.tasks.back();
+                target.tasks.pop_back();
+            }
+            else
+            {
+                task = target.tasks.front();
+                target.tasks.pop_front();
+            }
+        }
+        this->queued.fetch_sub(1, std::memory_order_relaxed);
+        task.join->run(*task.function);
+        // 计数归零后 join 可能立即被销毁, 之后不能再访问; 唤醒只经过线程池自己的 sleep_mutex 与 wake
+        if (task.join->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            {
+                const std::lock_guard<std::mutex> lock(this->sleep_mutex);
+            }
+            this->wake.notify_all();
+        }
+        return true;
+    }
+    return false;
+}
+
+void TaskPool::work(const std::size_t index)
+{
+    current_pool = this;
+    current_queue = index;
+    while (true)
+    {
+        if (this->run_one(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        this->wake.wait(lock, [this] { return this->stopping || this->queued.load(std::memory_order_acquire) != 0; });
+        if (this->stopping)
+            return;
+    }
+}
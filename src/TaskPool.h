@@ -0,0 +1,68 @@
+#ifndef TASKPOOLCPP
+#define TASKPOOLCPP
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+// 并行乘法使用的执行器接口, 可以用来包装调用方自己的线程池
+class Executor
+{
+public:
+    virtual ~Executor() = default;
+
+    // 执行全部任务, 全部完成后才返回; 任务中可以再次调用 fork_join
+    // 任务抛出的第一个异常在返回时重新抛出
+    virtual void fork_join(std::span<const std::function<void()>> tasks) = 0;
+};
+
+// 工作窃取线程池: 每个工作线程有自己的双端队列, 从队尾取出自己提交的任务, 空闲时从其他队列的队首窃取
+// 等待 fork_join 的线程先继续执行队列中的任务, 因此嵌套的 fork_join 不会死锁; 没有任务可做时才阻塞等待
+class TaskPool : public Executor
+{
+public:
+    // threads 为工作线程数, 调用 fork_join 的线程也会参与执行
+    explicit TaskPool(const std::size_t threads);
+    ~TaskPool() override;
+
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    std::size_t size() const;
+    void fork_join(std::span<const std::function<void()>> tasks) override;
+
+    // 进程内共享的线程池, 第一次使用时创建 hardware_concurrency - 1 个工作线程
+    static TaskPool &shared();
+
+private:
+    struct Join;
+    struct Task
+    {
+        const std::function<void()> *function;
+        Join *join;
+    };
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::size_t local_queue() const;
+    bool run_one(const std::size_t queue);
+    void work(const std::size_t index);
+
+private:
+    // 每个工作线程一个队列, 最后一个队列由其他线程共用
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<std::size_t> queued{0};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+#endif